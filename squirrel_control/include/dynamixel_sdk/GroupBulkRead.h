@@ -28,17 +28,20 @@ private:
     std::map<UINT8_T, UINT16_T>     address_list_;  // <id, start_address>
     std::map<UINT8_T, UINT16_T>     length_list_;   // <id, data_length>
     std::map<UINT8_T, UINT8_T *>    data_list_;     // <id, data>
+    std::map<UINT8_T, int>          result_list_;   // <id, comm result>
 
     bool            last_result_;
     bool            is_param_changed_;
 
     UINT8_T        *param_;
 
+    UINT8_T        *rxpacket_;
+
     void    MakeParam();
 
 public:
     GroupBulkRead(PortHandler *port, PacketHandler *ph);
-    ~GroupBulkRead() { ClearParam(); }
+    ~GroupBulkRead() { ClearParam(); delete[] rxpacket_; }
 
     PortHandler     *GetPortHandler()   { return port_; }
     PacketHandler   *GetPacketHandler() { return ph_; }
@@ -52,6 +55,7 @@ public:
     int     TxRxPacket();
 
     bool        IsAvailable (UINT8_T id, UINT16_T address, UINT16_T data_length);
+    int         GetResult   (UINT8_T id);
     UINT32_T    GetData     (UINT8_T id, UINT16_T address, UINT16_T data_length);
 };
 
@@ -26,6 +26,7 @@ private:
 
     std::vector<UINT8_T>            id_list_;
     std::map<UINT8_T, UINT8_T* >    data_list_; // <id, data>
+    std::map<UINT8_T, int>          result_list_; // <id, comm result>
 
     bool            last_result_;
     bool            is_param_changed_;
@@ -34,11 +35,13 @@ private:
     UINT16_T        start_address_;
     UINT16_T        data_length_;
 
+    UINT8_T        *rxpacket_;
+
     void    MakeParam();
 
 public:
     GroupSyncRead(PortHandler *port, PacketHandler *ph, UINT16_T start_address, UINT16_T data_length);
-    ~GroupSyncRead() { ClearParam(); }
+    ~GroupSyncRead() { ClearParam(); delete[] rxpacket_; }
 
     PortHandler     *GetPortHandler()   { return port_; }
     PacketHandler   *GetPacketHandler() { return ph_; }
@@ -52,6 +55,7 @@ public:
     int     TxRxPacket();
 
     bool        IsAvailable (UINT8_T id, UINT16_T address, UINT16_T data_length);
+    int         GetResult   (UINT8_T id);
     UINT32_T    GetData     (UINT8_T id, UINT16_T address, UINT16_T data_length);
 };
 
@@ -78,6 +78,7 @@ public:
 
     // BroadcastPing
     virtual int BroadcastPing   (PortHandler *port, std::vector<UINT8_T> &id_list) = 0;
+    virtual int BroadcastPing   (PortHandler *port, std::vector<UINT8_T> &id_list, std::vector<UINT16_T> &model_list) = 0;
 
     virtual int Action          (PortHandler *port, UINT8_T id) = 0;
     virtual int Reboot          (PortHandler *port, UINT8_T id, UINT8_T *error = 0) = 0;
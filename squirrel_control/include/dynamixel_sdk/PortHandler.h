@@ -20,6 +20,8 @@
 
 #include <dynamixel_sdk/RobotisDef.h>
 
+#define PACKET_BUFFER_LEN   (4*1024)    // largest Protocol 2.0 packet
+
 namespace ROBOTIS
 {
 
@@ -32,6 +34,10 @@ public:
 
     bool    is_using;
 
+    // scratch space of the packet handler, reused by every transaction on this port instead of per-call buffers
+    UINT8_T tx_packet[PACKET_BUFFER_LEN];
+    UINT8_T rx_packet[PACKET_BUFFER_LEN];
+
     virtual ~PortHandler() { }
 
     virtual bool    OpenPort() = 0;
@@ -52,6 +58,12 @@ public:
     virtual void    SetPacketTimeout(UINT16_T packet_length) = 0;
     virtual void    SetPacketTimeout(double msec) = 0;
     virtual bool    IsPacketTimeout() = 0;
+
+    // wait in ReadPort() for data until the packet timeout instead of returning immediately
+    virtual void    SetBlockingRead(bool enable) { }
+
+    // configure the adapter for minimal receive latency when the port is opened
+    virtual void    SetLowLatency(bool enable) { }
 };
 
 }
@@ -24,11 +24,19 @@ private:
     double  packet_start_time_;
     double  packet_timeout_;
     double  tx_time_per_byte;
+    bool    blocking_read_;
+    bool    low_latency_;
+    double  latency_timer_;
 
     bool    SetupPort(const int cflag_baud);
     bool    SetCustomBaudrate(int speed);
     int     GetCFlagBaud(const int baudrate);
 
+    bool    SetupLowLatency();
+    bool    GetLatencyTimerPath(char *path, int length);
+    int     ReadLatencyTimer();
+    bool    WriteLatencyTimer(int msec);
+
     double  GetCurrentTime();
     double  GetTimeSinceStart();
 
@@ -54,6 +62,9 @@ public:
     void    SetPacketTimeout(UINT16_T packet_length);
     void    SetPacketTimeout(double msec);
     bool    IsPacketTimeout();
+
+    void    SetBlockingRead(bool enable);
+    void    SetLowLatency(bool enable);
 };
 
 }
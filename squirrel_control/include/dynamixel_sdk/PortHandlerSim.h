@@ -0,0 +1,139 @@
+/*
+ * PortHandlerSim.h
+ *
+ *  In-process Dynamixel Protocol 2.0 bus, answers the instruction packets written to it like the motors
+ *  described by the .device files would. Selected by GetPortHandler() for port names of the form
+ *
+ *      sim:<id>=<model number or name>[,<id>=<model>...][,<option>=<value>...]
+ *
+ *  e.g. "sim:1=46352,2=46352,3=PRO_L54_50_S500_R,latency=4,drop=0.01". Options:
+ *      latency     msec, delay of the USB adapter until received bytes are visible (default 1)
+ *      byte_time   usec per byte on the bus (default 10 bits at the configured baud rate)
+ *      drop        probability that a device does not answer an instruction
+ *      corrupt     probability that a status packet is damaged on the bus
+ *      seed        seed of the error injection
+ */
+
+#ifndef DYNAMIXEL_SDK_INCLUDE_DYNAMIXEL_SDK_PORTHANDLERSIM_H_
+#define DYNAMIXEL_SDK_INCLUDE_DYNAMIXEL_SDK_PORTHANDLERSIM_H_
+
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <dynamixel_sdk/PortHandler.h>
+#include <dynamixel_sdk/dynamixel_tool.h>
+
+namespace ROBOTIS
+{
+
+// Control table and motion of one simulated motor
+class SimulatedDevice
+{
+public:
+    SimulatedDevice(UINT8_T id, dynamixel_tool::DynamixelTool *tool);
+    ~SimulatedDevice();
+
+    UINT8_T GetID() { return id_; }
+    UINT16_T GetModelNumber() { return tool_->model_number_; }
+    UINT16_T GetReturnDelayTime();
+
+    // false if the range is not part of the control table
+    bool    Read(UINT16_T address, UINT16_T length, UINT8_T *data);
+    bool    Write(UINT16_T address, UINT16_T length, const UINT8_T *data);
+
+    // moves the motor to the given time (msec) according to its operating mode and goals
+    void    Update(double time);
+
+private:
+    UINT8_T  id_;
+    dynamixel_tool::DynamixelTool *tool_;
+    std::vector<UINT8_T> table_;
+    double   position_;             // ticks, integrated in velocity mode
+    double   last_update_;
+
+    UINT16_T indirect_count_;
+
+    UINT16_T MapAddress(UINT16_T address);
+    INT32_T  GetValue(dynamixel_tool::ControlTableItem *item);
+    void     SetValue(dynamixel_tool::ControlTableItem *item, INT32_T value);
+};
+
+class PortHandlerSim : public PortHandler
+{
+private:
+    struct RxByte
+    {
+        UINT8_T data;
+        double  visible_time;       // msec
+    };
+
+    int     baudrate_;
+    char    port_name_[256];
+
+    double  packet_start_time_;
+    double  packet_timeout_;
+    double  tx_time_per_byte;
+    bool    blocking_read_;
+
+    double  latency_timer_;
+    double  byte_time_;             // msec, 0: derived from the baud rate
+    double  drop_rate_;
+    double  corrupt_rate_;
+    unsigned int seed_;
+
+    std::vector<SimulatedDevice *> devices_;
+    std::vector<UINT8_T> tx_buffer_;
+    std::deque<RxByte> rx_buffer_;
+
+    bool    ParsePortName(const char *port_name);
+    double  GetByteTime();
+    bool    Happens(double probability);
+
+    SimulatedDevice *FindDevice(UINT8_T id);
+    void    HandlePacket(std::vector<UINT8_T> &packet, double time);
+    double  SendStatus(SimulatedDevice *device, UINT8_T error, const UINT8_T *params, UINT16_T param_length, double time);
+
+    double  GetCurrentTime();
+    double  GetTimeSinceStart();
+
+public:
+    PortHandlerSim(const char *port_name);
+    virtual ~PortHandlerSim();
+
+    // adds a motor to the bus, model is a model number or name of the .device files
+    bool    AddDevice(UINT8_T id, const std::string &model);
+
+    void    SetLatencyTimer(double msec)    { latency_timer_ = msec; }
+    void    SetByteTime(double msec)        { byte_time_ = msec; }
+    void    SetDropRate(double probability)     { drop_rate_ = probability; }
+    void    SetCorruptRate(double probability)  { corrupt_rate_ = probability; }
+    void    SetSeed(unsigned int seed)      { seed_ = seed; }
+
+    bool    OpenPort();
+    void    ClosePort();
+    void    ClearPort();
+
+    void    SetPortName(const char *port_name);
+    char   *GetPortName();
+
+    bool    SetBaudRate(const int baudrate);
+    int     GetBaudRate();
+
+    int     GetBytesAvailable();
+
+    int     ReadPort(UINT8_T *packet, int length);
+    int     WritePort(UINT8_T *packet, int length);
+
+    void    SetPacketTimeout(UINT16_T packet_length);
+    void    SetPacketTimeout(double msec);
+    bool    IsPacketTimeout();
+
+    void    SetBlockingRead(bool enable);
+};
+
+}
+
+
+#endif /* DYNAMIXEL_SDK_INCLUDE_DYNAMIXEL_SDK_PORTHANDLERSIM_H_ */
@@ -40,6 +40,7 @@ public:
 
     // BroadcastPing
     int BroadcastPing   (PortHandler *port, std::vector<UINT8_T> &id_list);
+    int BroadcastPing   (PortHandler *port, std::vector<UINT8_T> &id_list, std::vector<UINT16_T> &model_list);
 
     int Action          (PortHandler *port, UINT8_T id);
     int Reboot          (PortHandler *port, UINT8_T id, UINT8_T *error = 0);
@@ -21,8 +21,7 @@ private:
 
     Protocol2PacketHandler();
 
-    UINT16_T    UpdateCRC(UINT16_T crc_accum, UINT8_T *data_blk_ptr, UINT16_T data_blk_size);
-    void        AddStuffing(UINT8_T *packet);
+    bool        AddStuffing(UINT8_T *packet);
     void        RemoveStuffing(UINT8_T *packet);
 
 public:
@@ -32,6 +31,9 @@ public:
 
     float   GetProtocolVersion() { return 2.0; }
 
+    // CRC-16 of the packet bytes, as computed for every Tx and checked for every Rx packet
+    UINT16_T    UpdateCRC(UINT16_T crc_accum, UINT8_T *data_blk_ptr, UINT16_T data_blk_size);
+
     void    PrintTxRxResult(int result);
     void    PrintRxPacketError(UINT8_T error);
 
@@ -44,6 +46,7 @@ public:
 
     // BroadcastPing
     int BroadcastPing   (PortHandler *port, std::vector<UINT8_T> &id_list);
+    int BroadcastPing   (PortHandler *port, std::vector<UINT8_T> &id_list, std::vector<UINT16_T> &model_list);
 
     int Action          (PortHandler *port, UINT8_T id);
     int Reboot          (PortHandler *port, UINT8_T id, UINT8_T *error = 0);
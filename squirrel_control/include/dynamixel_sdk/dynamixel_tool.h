@@ -37,7 +37,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <fstream>
+#include <istream>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <functional>
 #include <algorithm>
@@ -64,6 +66,42 @@ namespace dynamixel_tool {
         uint8_t data_length;
     };
 
+    // Items used by the driver, resolved once after the control table is loaded. Items the model does not
+    // provide are NULL.
+    struct ControlTableItems {
+        ControlTableItem *torque_enable;
+        ControlTableItem *operating_mode;
+        ControlTableItem *goal_position;
+        ControlTableItem *goal_velocity;
+        ControlTableItem *goal_torque;
+        ControlTableItem *present_position;
+        ControlTableItem *present_velocity;
+        ControlTableItem *present_current;
+        ControlTableItem *present_temperature;
+        ControlTableItem *hardware_error_status;
+        ControlTableItem *velocity_limit;
+        ControlTableItem *torque_limit;
+        ControlTableItem *external_port_data_1;
+        ControlTableItem *indirect_address_1;
+        ControlTableItem *indirect_data_1;
+    };
+
+    // Contents of a .device file. Parsed once per model and shared by all tools of that model, the control table
+    // items are owned by the registry in dynamixel_tool.cpp and live as long as the process.
+    struct ModelInfo {
+        std::string model_name;
+        uint16_t model_number;
+        double velocity_to_value_ratio;
+        double torque_to_current_value_ratio;
+        int32_t value_of_0_radian_position;
+        int32_t value_of_min_radian_position;
+        int32_t value_of_max_radian_position;
+        double min_radian;
+        double max_radian;
+        std::map<std::string, ControlTableItem> ctrl_table;
+        std::map<uint32_t, uint32_t> baud_rate_table;
+    };
+
     class DynamixelTool {
     public:
         uint8_t id_;
@@ -89,6 +127,8 @@ namespace dynamixel_tool {
 
         ControlTableItem *item_;
 
+        ControlTableItems items_;
+
     public:
         DynamixelTool(uint8_t id, uint16_t model_number, float protocol_version);
 
@@ -101,6 +141,25 @@ namespace dynamixel_tool {
         bool getModelName(uint16_t model_number);
 
         bool getModelItem();
+
+        // Returns the item or NULL if the model does not provide it
+        ControlTableItem *findItem(const std::string &item_name);
+
+        // Returns the item, throws if the model does not provide it
+        ControlTableItem *getItem(const std::string &item_name);
+
+        // Registers a compiled-in .device description, tools of this model then do not read the model files
+        static void registerModel(uint16_t model_number, const std::string &model_name, const std::string &device);
+
+    private:
+        // Registers the arm and neck models of builtin_models.cpp once per process, before the first lookup
+        static void registerBuiltinModels();
+
+        static bool parseModel(std::istream &stream, ModelInfo &model);
+
+        static void loadModelNames(const std::string &path);
+
+        void resolveItems();
     };
 }
 #endif //DYNAMIXEL_TOOL_H
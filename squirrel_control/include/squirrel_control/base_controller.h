@@ -5,6 +5,7 @@
 #include <geometry_msgs/Twist.h>
 #include <nav_msgs/Odometry.h>
 #include <boost/thread.hpp>
+#include <boost/chrono.hpp>
 #include <control_toolbox/pid.h>
 #include <tf/tf.h>
 #include <vector>
@@ -14,6 +15,20 @@
 
 namespace squirrel_control {
 
+    /** \brief Base setpoint in the odometry frame in x, y, yaw order, velocity and acceleration are fed forward */
+    struct BaseSetpoint {
+        double position[3];
+        double velocity[3];
+        double acceleration[3];
+    };
+
+    /** \brief Planar pose of the base in the odometry frame, theta is the yaw of the odometry orientation */
+    struct BasePose {
+        double x;
+        double y;
+        double theta;
+    };
+
     class BaseController {
 
     private:
@@ -25,12 +40,23 @@ namespace squirrel_control {
         ros::Subscriber subOdometry;
         ros::Publisher pubMove;
 
-        nav_msgs::Odometry odometry;
-
-        boost::thread* move_base_thread_;
-        boost::thread* ptp_base_thread_;
-        bool start_move_base_;
-        bool start_ptp_base_;
+        // The control thread sleeps on state_changed_ until a goal is active and odometry was received, and then
+        // runs at controller_frequency_ until the goal is reached. With odom_synchronised_ there is no control
+        // thread, every odometry message triggers one step from the subscriber callback instead. Odometry and goal
+        // are guarded by state_mutex_, the PIDs and current_base_vel_ are only used by the one stepping thread.
+        bool odom_synchronised_;
+        boost::thread* control_thread_;
+        boost::mutex state_mutex_;
+        boost::condition_variable state_changed_;
+        bool shutdown_;
+
+        BasePose pose_;             // of the latest odometry, the yaw is computed once in callbackOdometry
+        bool odom_received_;
+        ros::Time last_odom_stamp_;
+
+        bool goal_active_;
+        unsigned long goal_seq_;    // counts the goals, a goal reached by the thread is only ended if no newer one arrived
+        bool ptp_goal_;             // goal of ptp(), ended once every axis is close to its target, see targetReached()
         bool gotoCommand;
         double controller_frequency_, time_step_;
         double vel_ang_max_, vel_x_max_, vel_y_max_;
@@ -38,26 +64,30 @@ namespace squirrel_control {
         double p_x_;//, d_x_, i_x_, i_x_min_, i_x_max_;
         double p_y_;//, d_y_, i_y_, i_y_min_, i_y_max_;
 
-        double desired_theta_, desired_x_, desired_y_;
-        double desired_theta_ptp, desired_x_ptp, desired_y_ptp;
+        BaseSetpoint goal_;
+        double start_theta_ptp, start_x_ptp, start_y_ptp;
         control_toolbox::Pid pid_theta_;
         control_toolbox::Pid pid_x_;
         control_toolbox::Pid pid_y_;
         geometry_msgs::Twist current_base_vel_;
 
-        boost::mutex robot_pose_mutex_;
-        boost::mutex move_pose_mutex_;
-        boost::mutex ptp_pose_mutex_;
-        void ptpBaseThread();
-        void callbackOdometry(nav_msgs::Odometry msg);
-        void moveBaseThread();
+        void controlThread();
+        // one PID step towards the goal, publishes the twist and returns true once the goal is reached
+        bool updateCommand(const BasePose& pose, const BaseSetpoint& goal, bool clamp, double dt);
+        // whether a ptp() goal is close enough to be ended, state_mutex_ has to be held
+        bool ptpReached(const BasePose& pose);
 
         geometry_msgs::Twist getNullTwist();
         double rotationDifference(double angle, double theta_robot);
-        void move(double desired_x, double desired_y,double desired_theta);
+        void move(const BaseSetpoint& setpoint, bool ptp);
         void initialize(ros::NodeHandle& node);
         bool targetReached(float currentVal, float targetVal, float startingVal);
 
+    protected:
+
+        /** \brief Handles one odometry message of ROBOTINO_ODOM_TOPIC, with odom_synchronised it runs a control step */
+        void callbackOdometry(const nav_msgs::OdometryConstPtr& msg);
+
     public:
 
         BaseController(ros::NodeHandle& node, double controller_freq);
@@ -65,7 +95,12 @@ namespace squirrel_control {
 
         void ptp(double desired_x, double desired_y,double desired_theta);
         void moveBase(double desired_x, double desired_y,double desired_theta);
+        /** \brief Follow a moving setpoint, its velocity and acceleration are added to the PID output */
+        void moveBase(const BaseSetpoint& setpoint);
         void gotoBase(double desired_x, double desired_y,double desired_theta);
+        /** \brief Pose of the latest odometry, does not allocate */
+        BasePose getCurrentPose();
+        /** \brief Pose of the latest odometry as x, y, yaw */
         std::vector<double> getCurrentState();//
 
     };
@@ -0,0 +1,103 @@
+#ifndef SQUIRREL_CONTROL_LATENCY_HISTOGRAM_H
+#define SQUIRREL_CONTROL_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <stdint.h>
+#include <time.h>
+
+namespace squirrel_control {
+
+	/**
+	 * \brief Log-linear histogram of durations in nanoseconds, in the style of HdrHistogram.
+	 *
+	 * Every power of two is split into 32 linear buckets, so reported values are within ~3% of the
+	 * recorded ones. record() is lock-free and meant to be called from a single thread (the control
+	 * loop), the statistics can be read concurrently from any other thread.
+	 */
+	class LatencyHistogram {
+		public:
+			LatencyHistogram() : count_(0), max_(0) {
+				for (int i = 0; i < BUCKET_COUNT; ++i)
+					buckets_[i].store(0, std::memory_order_relaxed);
+			}
+
+			void record(uint64_t nanoseconds) {
+				buckets_[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+				count_.fetch_add(1, std::memory_order_relaxed);
+				if (nanoseconds > max_.load(std::memory_order_relaxed))
+					max_.store(nanoseconds, std::memory_order_relaxed);
+			}
+
+			/** \brief Record the time from start until now */
+			void recordSince(const struct timespec &start) {
+				record(elapsedNanoseconds(start, now()));
+			}
+
+			uint64_t count() const {
+				return count_.load(std::memory_order_relaxed);
+			}
+
+			uint64_t max() const {
+				return max_.load(std::memory_order_relaxed);
+			}
+
+			/** \brief Upper bound of the bucket holding the given percentile (0-100), 0 if nothing was recorded */
+			uint64_t percentile(double percent) const {
+				uint64_t total = count();
+				if (total == 0)
+					return 0;
+				uint64_t rank = static_cast<uint64_t>(percent / 100.0 * total + 0.5);
+				if (rank < 1)
+					rank = 1;
+				uint64_t seen = 0;
+				for (int i = 0; i < BUCKET_COUNT; ++i) {
+					seen += buckets_[i].load(std::memory_order_relaxed);
+					if (seen >= rank)
+						return bucketUpperBound(i) < max() ? bucketUpperBound(i) : max();
+				}
+				return max();
+			}
+
+			static struct timespec now() {
+				struct timespec time;
+				clock_gettime(CLOCK_MONOTONIC, &time);
+				return time;
+			}
+
+			static uint64_t elapsedNanoseconds(const struct timespec &start, const struct timespec &end) {
+				int64_t elapsed = (int64_t) (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+				return elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0;
+			}
+
+		private:
+			static const int SUB_BUCKET_BITS = 5;
+			static const int SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+			// values up to 2^40 ns (~18 min), larger ones land in the last bucket
+			static const int MAX_SHIFT = 40 - SUB_BUCKET_BITS;
+			static const int BUCKET_COUNT = (MAX_SHIFT + 2) * SUB_BUCKET_COUNT;
+
+			static int bucketIndex(uint64_t value) {
+				if (value < 2 * SUB_BUCKET_COUNT)
+					return static_cast<int>(value);
+				int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+				if (shift > MAX_SHIFT)
+					return BUCKET_COUNT - 1;
+				return (shift + 1) * SUB_BUCKET_COUNT + static_cast<int>((value >> shift) - SUB_BUCKET_COUNT);
+			}
+
+			static uint64_t bucketUpperBound(int index) {
+				if (index < 2 * SUB_BUCKET_COUNT)
+					return index;
+				int shift = index / SUB_BUCKET_COUNT - 1;
+				uint64_t sub_bucket = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+				return ((sub_bucket + 1) << shift) - 1;
+			}
+
+			std::atomic<uint64_t> buckets_[BUCKET_COUNT];
+			std::atomic<uint64_t> count_;
+			std::atomic<uint64_t> max_;
+	};
+
+}
+
+#endif //SQUIRREL_CONTROL_LATENCY_HISTOGRAM_H
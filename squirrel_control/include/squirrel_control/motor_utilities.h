@@ -7,21 +7,63 @@
 
 #include <mutex>
 #include <cmath>
+#include <map>
+#include <algorithm>
 #include <unistd.h>
 #include <error/throwControlError.h>
 
 #include "squirrel_control/control_modes.h"
+#include "squirrel_control/latency_histogram.h"
 
 #include <dynamixel_sdk/PortHandler.h>
 #include <dynamixel_sdk/Protocol2PacketHandler.h>
+#include <dynamixel_sdk/GroupSyncRead.h>
+#include <dynamixel_sdk/GroupSyncWrite.h>
+#include <dynamixel_sdk/GroupBulkRead.h>
+#include <dynamixel_sdk/GroupBulkWrite.h>
 #include <dynamixel_sdk/dynamixel_tool.h>
 
 
 namespace motor_control
 {
+    enum StateField {
+        POSITION_FIELD,
+        VELOCITY_FIELD,
+        CURRENT_FIELD,
+        HARDWARE_ERROR_FIELD,
+        TEMPERATURE_FIELD,
+        STATE_FIELD_COUNT
+    };
+
+    /** Address range a motor answers a state read with, and where the state fields are inside of it */
+    struct StateLayout {
+        UINT16_T start_address;
+        UINT16_T data_length;                       // 0 if the motor cannot be read as one block
+        UINT16_T field_offset[STATE_FIELD_COUNT];
+        UINT8_T field_length[STATE_FIELD_COUNT];    // 0 for fields that are not read
+    };
+
     struct Motor {
         UINT8_T id;
         dynamixel_tool::DynamixelTool *tool;
+        int32_t velocity_limit;     // raw, read once at initMotors(), -1 if the motor does not provide it
+        int32_t torque_limit;       // raw current units, read once at initMotors(), -1 if the motor does not provide it
+        StateLayout layout;         // set up at initMotors()
+    };
+
+    /** A servo on the motor port that is not part of the arm, e.g. pan or tilt of the neck */
+    struct Device {
+        std::string name;
+        Motor motor;
+    };
+
+    struct MotorState {
+        double position;        // rad
+        double velocity;        // rad/s
+        double effort;          // Nm
+        int hardware_error;     // only read with indirect read enabled
+        int temperature;        // degree Celsius, only read with indirect read enabled
+        int comm_result;
     };
 
 
@@ -54,6 +96,28 @@ namespace motor_control
 
         std::vector<Motor> getMotors();
 
+        /**
+            Registers a servo that shares the motor port with the arm but is not an arm joint, e.g. pan or tilt of
+                the neck. Devices are read in the same transaction as the arm, are always position controlled and
+                keep their torque across setMode(). Has to be called before initMotors().
+
+            @param name, the name the device is looked up by
+            @param id, the Dynamixel ID of the device, it has to speak protocol 2.0
+        */
+        void addDevice(const std::string &name, int id);
+
+        /** The registered devices that answered at initMotors(), in the order of deviceStates() */
+        const std::vector<Device>& getDevices();
+
+        /** @return the index of the device with the given name, -1 if it is not registered or did not answer */
+        int findDevice(const std::string &name);
+
+        /** States of the devices, updated by readStates() and read() */
+        const std::vector<MotorState>& deviceStates();
+
+        /** Sets the goal position of a device in rad, it is sent with the arm's goals of the next write() */
+        void setDeviceGoal(std::size_t device, double position);
+
         void setMode(control_modes::ControlMode mode);
 
         control_modes::ControlMode getMode();
@@ -62,13 +126,69 @@ namespace motor_control
             Writes the high level control commands to the motor. this operation supports all three operating modes, i.e.,
                 position mode, velocity mode, and torque mode
 
-            @param commands, a vector of either (i) joint position, (ii) joint velocities, or (iii) joint torques
-                depending on the current operation mode; the length of this vector is expected to be this.motors.size
+            @param commands, a vector of either (i) joint positions in rad, (ii) joint velocities in rad/s, or (iii)
+                joint torques in Nm depending on the current operation mode; the length of this vector is expected to
+                be this.motors.size
             @return true in case of success
         */
-        bool write(std::vector<double>commands);
+        bool write(const std::vector<double> &commands);
 
+        /** Reads the quantity of the current mode, i.e. positions in rad, velocities in rad/s or torques in Nm */
         std::vector<double> read();
+        /** Like read(), but fills values, which only allocates if it has to grow */
+        void read(std::vector<double> &values);
+
+        /**
+            Reads present position, velocity and current of all motors and devices, plus hardware error status and
+                temperature if indirect read is enabled. With sync read enabled this is a single SYNC_READ
+                transaction, or a single BULK_READ if the motors' control tables differ; motors that did not answer
+                are re-read individually.
+
+            @return the state of each motor in the order of getMotors(); the buffer is owned by this object
+        */
+        const std::vector<MotorState>& readStates();
+
+        void setSyncRead(bool enabled);
+
+        bool syncReadEnabled();
+
+        void setSyncWrite(bool enabled);
+
+        bool syncWriteEnabled();
+
+        /**
+            Maps all state fields into the indirect data region of each motor at initMotors(), so that they can be
+                read as one block. Has to be set before initMotors().
+        */
+        void setIndirectRead(bool enabled);
+
+        bool indirectReadEnabled();
+
+        /**
+            Sends the SYNC_READ for the next cycle right after the goals in write(), so that the bus answers while the
+                controllers compute; readStates() then only collects the status packets. The states are sampled at
+                the end of the previous write() instead of at the start of readStates().
+        */
+        void setPipelinedRead(bool enabled);
+
+        bool pipelinedReadEnabled();
+
+        /**
+            Lets the port sleep in poll() until status packets arrive instead of spinning until the packet timeout.
+                Has to be set before initMotors().
+        */
+        void setBlockingRead(bool enabled);
+
+        /**
+            Sets ASYNC_LOW_LATENCY and the smallest USB latency timer on the motor port, packet timeouts follow the
+                latency timer the adapter reports. Has to be set before initMotors().
+        */
+        void setLowLatency(bool enabled);
+
+        /** Bus time of each state read and goal write transaction, safe to read from any thread */
+        const squirrel_control::LatencyHistogram& busReadTiming() const;
+
+        const squirrel_control::LatencyHistogram& busWriteTiming() const;
 
 
     private:	
@@ -86,6 +206,87 @@ namespace motor_control
         ROBOTIS::PortHandler* port_handler_;
 
         ROBOTIS::PacketHandler* packet_handler_;
+
+        bool blocking_read_ = true;
+
+        bool low_latency_ = true;
+
+        squirrel_control::LatencyHistogram bus_read_timing_;
+
+        squirrel_control::LatencyHistogram bus_write_timing_;
+
+        std::vector<Device> devices_;
+
+        std::vector<int> device_ids_;           // registered by addDevice(), in the order of device_names_
+
+        std::vector<std::string> device_names_;
+
+        std::vector<MotorState> device_states_;
+
+        std::vector<int32_t> device_goals_;     // raw goal positions
+
+        // the arm motors followed by the devices, in the order of the batched transactions
+        std::size_t busSize() const;
+
+        Motor& busMotor(std::size_t index);
+
+        MotorState& busState(std::size_t index);
+
+        // Batched state read, a SYNC_READ if all motors share a state layout, otherwise a BULK_READ
+        bool sync_read_enabled_ = true;
+
+        ROBOTIS::GroupSyncRead* sync_read_ = nullptr;
+
+        ROBOTIS::GroupBulkRead* bulk_read_ = nullptr;
+
+        bool indirect_read_enabled_ = false;
+
+        bool indirect_read_active_ = false;
+
+        bool state_read_ready_ = false;
+
+        std::vector<MotorState> motor_states_;
+
+        std::vector<UINT8_T> state_buffer_;
+
+        bool pipelined_read_enabled_ = false;
+
+        bool state_request_pending_ = false;
+
+        bool setupStateRead();
+
+        bool stateLayout(const Motor &motor, bool indirect, StateLayout &layout);
+
+        bool setupIndirectRead(const Motor &motor);
+
+        void requestStates();
+
+        void discardStateRequest();
+
+        bool readStateSingle(const Motor &motor, MotorState &state);
+
+        void decodeState(const Motor &motor, const UINT32_T (&values)[STATE_FIELD_COUNT], MotorState &state);
+
+        // Batched goal write, a SYNC_WRITE if all goals share an address, otherwise a BULK_WRITE
+        bool sync_write_enabled_ = true;
+
+        ROBOTIS::GroupSyncWrite* sync_write_ = nullptr;
+
+        ROBOTIS::GroupBulkWrite* bulk_write_ = nullptr;
+
+        std::vector<dynamixel_tool::ControlTableItem*> goal_items_;    // indexed like busMotor()
+
+        std::vector<int32_t> goal_values_;
+
+        bool setupSyncWrite();
+
+        int32_t goalValue(const Motor &motor, double command);
+
+        int32_t positionValue(const Motor &motor, double position);
+
+        void readLimits(Motor &motor);
+
+        int writeGoalSingle(const Motor &motor, dynamixel_tool::ControlTableItem *item, int32_t value);
     };
 
 }
@@ -7,7 +7,11 @@
 
 
 #include <time.h>
+#include <atomic>
+#include <thread>
 #include <squirrel_control/squirrel_hw_interface.h>
+#include <squirrel_control/latency_histogram.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 
 namespace squirrel_control {
     // Used to convert seconds elapsed to nanoseconds
@@ -41,6 +45,9 @@ namespace squirrel_control {
          */
         void update(const ros::TimerEvent& e);
 
+        /** \brief One read, controller update, write cycle */
+        void update();
+
     protected:
         // Startup and shutdown of the internal node inside a roscpp program
         ros::NodeHandle nh_;
@@ -54,6 +61,37 @@ namespace squirrel_control {
 
         // Timing
         ros::Timer non_realtime_loop_;
+
+        // Dedicated control thread, used instead of the timer if realtime is set
+        bool realtime_;
+        int realtime_priority_;
+        int cpu_affinity_;
+        bool lock_memory_;
+        std::thread realtime_loop_;
+        std::atomic<bool> running_;
+
+        /** \brief Runs update() at loop_hz_ on absolute CLOCK_MONOTONIC deadlines */
+        void realtimeLoop();
+
+        /** \brief Apply SCHED_FIFO priority and CPU affinity to the calling thread */
+        void configureRealtimeThread();
+
+        // Per-phase timing of the control cycle, recorded lock-free and reported outside of the loop
+        LatencyHistogram cycle_timing_;
+        LatencyHistogram read_timing_;
+        LatencyHistogram update_timing_;
+        LatencyHistogram write_timing_;
+        // longest cycle since the last diagnostics message, the histograms above cover the whole run
+        std::atomic<uint64_t> worst_cycle_since_report_;
+        ros::Publisher diagnostics_pub_;
+        ros::Timer diagnostics_timer_;
+        std::string timing_dump_file_;
+
+        /** \brief Publish p50/p99/max of all phases and of the motor bus on /diagnostics */
+        void publishDiagnostics(const ros::TimerEvent& e);
+
+        /** \brief Collect p50/p99/max of all phases and of the motor bus in microseconds */
+        std::vector<diagnostic_msgs::KeyValue> timingValues();
         ros::Duration elapsed_time_;
         double loop_hz_;
         struct timespec last_time_;
@@ -8,6 +8,7 @@
 // C++
 #include <boost/scoped_ptr.hpp>
 #include <mutex>
+#include <map>
 #include <math.h>
 
 // ROS
@@ -29,11 +30,13 @@
 
 #include "squirrel_control/motor_utilities.h"
 #include "squirrel_control/base_controller.h"
+#include "squirrel_control/triple_buffer.h"
 #include "control_modes.h"
 #include <squirrel_safety_msgs/Safety.h>
 #include <std_msgs/Int16.h>
 #include <control_msgs/JointTrajectoryControllerState.h>
 #include <sensor_msgs/JointState.h>
+#include <realtime_tools/realtime_publisher.h>
 
 namespace squirrel_control {
 
@@ -42,6 +45,32 @@ namespace squirrel_control {
 #define VELOCITY_JOINT_INTERFACE "hardware_interface::VelocityJointInterface"
 #define EFFORT_JOINT_INTERFACE "hardware_interface::EffortJointInterface"
 
+	/** \brief Final point of a trajectory command */
+	struct TrajectoryGoal {
+		std::vector<double> positions;   // in the order of the configured joints
+		ros::Time stamp;
+	};
+
+	/** \brief Hardware behind a joint */
+	enum JointDevice {
+		UNMAPPED_DEVICE,
+		BASE_DEVICE,
+		ARM_DEVICE,
+		SERVO_DEVICE
+	};
+
+	/** \brief Resolved location of a joint: odometry axis of the base, motor index of the arm or index of a servo device */
+	struct JointMapping {
+		JointDevice device;
+		std::size_t channel;
+	};
+
+	/** \brief Base pose (x, y, yaw) and velocity as received from odometry */
+	struct BaseOdom {
+		double position[3];
+		double velocity[3];
+	};
+
 	class SquirrelHWInterface : public hardware_interface::RobotHW {
 
 		public:
@@ -112,6 +141,9 @@ namespace squirrel_control {
             /** \brief Return the value of the reset signal */
             bool getResetSignal();
 
+            /** \brief Motor interface of the arm, e.g. for its bus timing */
+            motor_control::MotorUtilities* getMotorInterface();
+
             /** \brief Joint trajectory command callbacl */
             virtual void commandCallback(const trajectory_msgs::JointTrajectoryConstPtr &msg);
 
@@ -120,6 +152,18 @@ namespace squirrel_control {
 			/** \brief Get the URDF XML from the parameter server */
 			virtual void loadURDF(ros::NodeHandle& nh, std::string param_name);
 
+			/** \brief Resolve the device and channel of every configured joint */
+			void buildJointMapping();
+
+			/** \brief Allocate the state messages once the joints are known */
+			void initStatePublishers();
+
+			/**
+			 * \brief Hand the current arm and base positions to the state publishers without blocking
+			 * \return true if both messages were queued
+			 */
+			bool publishStates(const std::vector<double> &positions, bool force);
+
 			bool enabled_;
 
 			// Short name of this class
@@ -151,6 +195,15 @@ namespace squirrel_control {
 			std::size_t num_joints_;
 			urdf::Model *urdf_model_;
 
+			// Joint to hardware mapping, resolved once in init()
+			std::vector<std::string> base_joint_names_;
+			std::vector<std::string> arm_joint_names_;
+			std::vector<int> motor_ids_;
+			std::vector<std::string> device_joint_names_;   // servos on the arm's bus, e.g. pan and tilt
+			std::vector<int> device_ids_;
+			std::vector<JointMapping> joint_mapping_;   // indexed like joint_names_
+			std::map<std::string, std::size_t> joint_index_;
+
 			// Modes
 			bool use_rosparam_joint_limits_;
 			bool use_soft_limits_if_available_;
@@ -171,15 +224,22 @@ namespace squirrel_control {
 			std::vector<double> joint_velocity_limits_;
 			std::vector<double> joint_effort_limits_;
 
-			double posBuffer_[3];
-			double velBuffer_[3];
+			// Arm quantities in motor order, sized in init() so that read() and write() do not allocate
+			std::vector<double> arm_values_;
+			std::vector<double> arm_positions_;
+			std::vector<double> arm_commands_;
+
+			// Latest odometry, written by odomCallback() and read once per control cycle without locking
+			TripleBuffer<BaseOdom> odom_buffer_;
+			BaseOdom odom_ = {};
             std::vector<double> base_cmds_;
 
 			// Base
 			ros::Publisher base_interface_;
 			ros::Subscriber base_state_;
 			BaseController base_controller_;
-			std::mutex odom_lock_;
+			BaseSetpoint base_setpoint_;
+			bool base_feed_forward_;
 			//tf::TransformListener transform_listener_;
 			//tf::StampedTransform latest_common_transform_;
 
@@ -194,11 +254,16 @@ namespace squirrel_control {
             // Resetting controller
             bool reset_signal_;
             ros::Subscriber trajectory_command_sub_;
-            ros::Publisher state_pub_;
-            ros::Publisher control_pub_;
+            // Published from the realtime publishers' own threads, at most state_publish_rate_ times per second
+            boost::scoped_ptr<realtime_tools::RealtimePublisher<sensor_msgs::JointState> > state_pub_;
+            boost::scoped_ptr<realtime_tools::RealtimePublisher<control_msgs::JointTrajectoryControllerState> > control_pub_;
+            double state_publish_rate_;
+            ros::Time last_state_publish_time_;
             bool first_broadcast_;
-            std::vector<double> last_trajectory_goal_;
-            ros::Time last_trajectory_time_;
+            // Trajectory goals, handed from commandCallback() to the control loop without locking. All three are sized in init().
+            TripleBuffer<TrajectoryGoal> goal_buffer_;
+            TrajectoryGoal command_goal_;       // owned by commandCallback()
+            TrajectoryGoal trajectory_goal_;    // owned by the control loop
 	};
 
 }
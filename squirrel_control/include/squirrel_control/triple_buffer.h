@@ -0,0 +1,58 @@
+#ifndef SQUIRREL_CONTROL_TRIPLE_BUFFER_H
+#define SQUIRREL_CONTROL_TRIPLE_BUFFER_H
+
+#include <atomic>
+
+namespace squirrel_control {
+
+	/**
+	 * \brief Lock-free hand over of the latest value from one writer thread to one reader thread.
+	 *
+	 * Writer and reader each own one of the three slots, the third one is exchanged atomically.
+	 * Neither side ever waits for the other, the reader always sees the most recently completed write.
+	 */
+	template <typename T>
+	class TripleBuffer {
+		public:
+			TripleBuffer() : buffers_(), front_(0), middle_(1), back_(2) {}
+
+			/** \brief Initialise all slots, e.g. to preallocate them. Not thread-safe, call before the threads start */
+			void reset(const T &value) {
+				for (int i = 0; i < 3; ++i)
+					buffers_[i] = value;
+				front_ = 0;
+				middle_.store(1);
+				back_ = 2;
+			}
+
+			/** \brief Publish a value, must only be called from the writer thread */
+			void write(const T &value) {
+				buffers_[back_] = value;
+				back_ = middle_.exchange(back_ | DIRTY, std::memory_order_acq_rel) & INDEX_MASK;
+			}
+
+			/**
+			 * \brief Copy the latest published value, must only be called from the reader thread
+			 * \return true if a new value was published since the last call
+			 */
+			bool read(T &value) {
+				bool fresh = (middle_.load(std::memory_order_relaxed) & DIRTY) != 0;
+				if (fresh)
+					front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX_MASK;
+				value = buffers_[front_];
+				return fresh;
+			}
+
+		private:
+			static const unsigned DIRTY = 4;
+			static const unsigned INDEX_MASK = 3;
+
+			T buffers_[3];
+			unsigned front_;
+			std::atomic<unsigned> middle_;
+			unsigned back_;
+	};
+
+}
+
+#endif //SQUIRREL_CONTROL_TRIPLE_BUFFER_H
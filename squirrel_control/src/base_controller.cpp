@@ -8,6 +8,11 @@ using namespace std;
 
 namespace squirrel_control {
 
+    static BaseSetpoint positionSetpoint(double x, double y, double theta) {
+        BaseSetpoint setpoint = {{x, y, theta}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
+        return setpoint;
+    }
+
     void BaseController::initialize(ros::NodeHandle& node){
 
         private_nh.param("baseControl/proportional_theta", p_theta_, 0.8);
@@ -32,6 +37,10 @@ namespace squirrel_control {
         private_nh.param("baseControl/vel_x_max", vel_x_max_, 0.5);
         private_nh.param("baseControl/vel_y_max", vel_y_max_, 0.5);
 
+        // compute and send a command as soon as odometry arrives, with the time between the odometry stamps as
+        // time step, instead of at controller_frequency_ on the latest odometry
+        private_nh.param("baseControl/odom_synchronised", odom_synchronised_, false);
+
         pid_theta_.initPid(p_theta_, 0.0,0.0,0.0,0.0);
         pid_x_.initPid(p_x_, 0.0,0.0,0.0,0.0);
         pid_y_.initPid(p_y_, 0.0,0.0,0.0,0.0);
@@ -44,14 +53,17 @@ namespace squirrel_control {
         sleep(1);
         //std::this_thread::sleep_for(std::chrono::milliseconds(100));
         gotoCommand=false;
-        move_base_thread_ = new boost::thread(boost::bind(&BaseController::moveBaseThread, this));
-        //ptp_base_thread_ = new boost::thread(boost::bind(&BaseController::ptpBaseThread, this));
+        control_thread_ = odom_synchronised_ ? NULL : new boost::thread(boost::bind(&BaseController::controlThread, this));
     }
 
     BaseController::BaseController(ros::NodeHandle& node,double controller_freq):
-        start_move_base_(false),
-        start_ptp_base_(false),
         private_nh("~"),
+        shutdown_(false),
+        pose_(),
+        odom_received_(false),
+        goal_active_(false),
+        goal_seq_(0),
+        ptp_goal_(false),
         controller_frequency_(controller_freq)
         {
             this->initialize(node);
@@ -59,30 +71,69 @@ namespace squirrel_control {
 
     BaseController::~BaseController() {
 
-        move_base_thread_->interrupt();
-        move_base_thread_->join();
-        ptp_base_thread_->interrupt();
-        ptp_base_thread_->join();
-
-        delete ptp_base_thread_;
-        delete move_base_thread_;
+        {
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            shutdown_ = true;
+        }
+        state_changed_.notify_all();
+        if (control_thread_) {
+            control_thread_->join();
+            delete control_thread_;
+        }
     }
 
 
-    void BaseController::callbackOdometry(nav_msgs::Odometry msg) {
-        robot_pose_mutex_.lock();
-        odometry = msg;
-        robot_pose_mutex_.unlock();
+    void BaseController::callbackOdometry(const nav_msgs::OdometryConstPtr& msg) {
+        // the yaw is only needed in the plane, computing it here keeps the pose queries cheap
+        const geometry_msgs::Quaternion& orientation = msg->pose.pose.orientation;
+        tf::Quaternion quat(orientation.x, orientation.y, orientation.z, orientation.w);
+        quat.normalize();
+        BasePose pose = {msg->pose.pose.position.x, msg->pose.pose.position.y, tf::getYaw(quat)};
+
+        bool first, step;
+        double dt;
+        BaseSetpoint goal;
+        bool clamp, reached_ptp;
+        unsigned long goal_seq;
+        {
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            pose_ = pose;
+            first = !odom_received_;
+            odom_received_ = true;
+
+            // stamps that do not advance, e.g. from a source that does not set them, fall back to the nominal step
+            dt = (msg->header.stamp - last_odom_stamp_).toSec();
+            if (first || dt <= 0.0)
+                dt = time_step_;
+            last_odom_stamp_ = msg->header.stamp;
+
+            step = odom_synchronised_ && goal_active_ && !shutdown_;
+            if (step) {
+                goal = goal_;
+                clamp = gotoCommand;
+                goal_seq = goal_seq_;
+                reached_ptp = ptpReached(pose);
+            }
+        }
+
+        if (step) {
+            bool reached = reached_ptp || updateCommand(pose, goal, clamp, dt);
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            if (reached && goal_seq == goal_seq_)
+                goal_active_ = false;
+        }
+        // a goal that arrived before the first odometry can be followed now
+        else if (first)
+            state_changed_.notify_all();
     }
 
     void BaseController::ptp(double desired_x, double desired_y, double desired_theta){
-        ptp_pose_mutex_.lock();
-        desired_theta_ptp = desired_theta;
-        desired_x_ptp= desired_x;
-        desired_y_ptp = desired_y;
-        start_ptp_base_ = true;
-        ptp_pose_mutex_.unlock();
+        move(positionSetpoint(desired_x, desired_y, desired_theta), true);
+    }
 
+    bool BaseController::ptpReached(const BasePose& pose){
+        return ptp_goal_ && targetReached(pose.theta, goal_.position[2], start_theta_ptp)
+            && targetReached(pose.x, goal_.position[0], start_x_ptp) && targetReached(pose.y, goal_.position[1], start_y_ptp);
     }
 
     bool BaseController::targetReached(float currentVal, float targetVal , float startingVal){
@@ -99,110 +150,155 @@ namespace squirrel_control {
 
 
     void BaseController::moveBase(double desired_x, double desired_y,double desired_theta) {
-        gotoCommand=true;
-        start_ptp_base_=false;
-        move(desired_x, desired_y,desired_theta);
+        {
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            gotoCommand=true;
+        }
+        move(positionSetpoint(desired_x, desired_y, desired_theta), false);
+    }
+
+    void BaseController::moveBase(const BaseSetpoint& setpoint) {
+        {
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            gotoCommand=true;
+        }
+        move(setpoint, false);
     }
 
     void BaseController::gotoBase(double desired_x, double desired_y,double desired_theta) {
-        start_ptp_base_=false;
-        gotoCommand=true;
-        move(desired_x, desired_y,desired_theta);
+        {
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            gotoCommand=true;
+        }
+        move(positionSetpoint(desired_x, desired_y, desired_theta), false);
 
     }
 
 
-    void BaseController::move(double desired_x, double desired_y,double desired_theta) {
-
-        move_pose_mutex_.lock();
-        desired_theta_ = desired_theta;
-        desired_x_ = desired_x;
-        desired_y_ = desired_y;
-        start_move_base_ = true;
-        move_pose_mutex_.unlock();
+    void BaseController::move(const BaseSetpoint& setpoint, bool ptp) {
 
-    }
-    void BaseController::ptpBaseThread(){
-        while(1){
-            if (start_ptp_base_){
-                auto startingPose = getCurrentState();
-                auto current_pose = startingPose;
-
-                while (start_ptp_base_ && !(targetReached(current_pose.at(2),desired_theta_ptp,startingPose.at(2)) && targetReached(current_pose.at(0),desired_x_ptp,startingPose.at(0)) && targetReached(current_pose.at(1),desired_y_ptp,startingPose.at(1)))){
-                    move( desired_x_ptp,desired_y_ptp, desired_theta_ptp);
-                    current_pose = getCurrentState();
-                }
-                start_ptp_base_=false;
+        bool wake;
+        {
+            boost::lock_guard<boost::mutex> lock(state_mutex_);
+            goal_ = setpoint;
+            ptp_goal_ = ptp;
+            if (ptp) {
+                start_x_ptp = pose_.x;
+                start_y_ptp = pose_.y;
+                start_theta_ptp = pose_.theta;
             }
+            ++goal_seq_;
+            wake = !goal_active_;
+            goal_active_ = true;
         }
+        // an active goal is picked up at the next cycle, only the idle thread has to be woken
+        if (wake)
+            state_changed_.notify_all();
+
     }
 
-    void BaseController::moveBaseThread(){
+    void BaseController::controlThread(){
 
-        ros::Rate moveBaseRate(controller_frequency_);
+        const boost::chrono::steady_clock::duration period =
+            boost::chrono::duration_cast<boost::chrono::steady_clock::duration>(boost::chrono::duration<double>(time_step_));
+        boost::unique_lock<boost::mutex> lock(state_mutex_);
 
-        while (ros::ok){
+        while (!shutdown_ && ros::ok()) {
 
-            if(start_move_base_) {
+            // sleep until there is a goal to follow and a pose to follow it from
+            if (!goal_active_ || !odom_received_) {
+                state_changed_.wait(lock);
+                continue;
+            }
 
-                bool velExceeded=false;
-                current_base_vel_ = getNullTwist();
-                auto currentPose = getCurrentState();
-                double current_theta = currentPose.at(2);
-		double orient_error = 0.0;
-                if(std::isnan(desired_theta_) == 0){
-                    orient_error = rotationDifference(desired_theta_, current_theta);
-                    current_base_vel_.angular.z = pid_theta_.computeCommand(orient_error, ros::Duration(time_step_));
-                    if(fabs(current_base_vel_.angular.z) > vel_ang_max_) {
-                        if(gotoCommand)
-                            current_base_vel_.angular.z = (current_base_vel_.angular.z > 0 ? vel_ang_max_ : - vel_ang_max_);
-                        else
-                            velExceeded=true;
-                    }
+            boost::chrono::steady_clock::time_point next_cycle = boost::chrono::steady_clock::now() + period;
+            BasePose currentPose = pose_;
+            BaseSetpoint goal = goal_;
+            bool clamp = gotoCommand;
+            unsigned long goal_seq = goal_seq_;
+            bool reached_ptp = ptpReached(currentPose);
+            lock.unlock();
 
+            bool reached = reached_ptp || updateCommand(currentPose, goal, clamp, time_step_);
 
-                }
+            lock.lock();
+            if (reached && goal_seq == goal_seq_)
+                goal_active_ = false;
 
+            // fixed rate while a goal is active, new goals and odometry do not shorten the period
+            while (!shutdown_ && state_changed_.wait_until(lock, next_cycle) == boost::cv_status::no_timeout) {
+            }
+        }
 
-                double err_x_odom = std::isnan(desired_x_) == 0  ? desired_x_ - currentPose.at(0) : 0;
-                double err_y_odom = std::isnan(desired_y_) == 0  ? desired_y_ - currentPose.at(1) : 0;
+    }
 
+    bool BaseController::updateCommand(const BasePose& currentPose, const BaseSetpoint& goal, bool clamp, double dt){
+
+        bool velExceeded=false;
+        current_base_vel_ = getNullTwist();
+        double current_theta = currentPose.theta;
+        double cos_theta = cos(current_theta);
+        double sin_theta = sin(current_theta);
+
+        // the setpoint velocity, extrapolated over the step by its acceleration, is added to the PID output;
+        // axes that are not controlled (DONTCARE) get no feed forward either
+        double feed_forward[3];
+        bool moving = false;
+        for (int i = 0; i < 3; ++i) {
+            feed_forward[i] = std::isnan(goal.position[i]) == 0 ? goal.velocity[i] + goal.acceleration[i] * dt : 0.0;
+            moving = moving || feed_forward[i] != 0.0;
+        }
 
-                double err_x_r = cos(current_theta) * err_x_odom + sin(current_theta) * err_y_odom;
-                double err_y_r = -sin(current_theta) * err_x_odom + cos(current_theta) * err_y_odom;
-                current_base_vel_.linear.x = pid_x_.computeCommand(err_x_r, ros::Duration(time_step_));
-                if(fabs(current_base_vel_.linear.x) > vel_x_max_) {
-                    if (gotoCommand)
-                        current_base_vel_.linear.x= (current_base_vel_.linear.x > 0 ? vel_x_max_ : - vel_x_max_);
-                    else
-                        velExceeded=true;
-                }
+        double orient_error = 0.0;
+        if(std::isnan(goal.position[2]) == 0){
+            orient_error = rotationDifference(goal.position[2], current_theta);
+            current_base_vel_.angular.z = feed_forward[2] + pid_theta_.computeCommand(orient_error, ros::Duration(dt));
+            if(fabs(current_base_vel_.angular.z) > vel_ang_max_) {
+                if(clamp)
+                    current_base_vel_.angular.z = (current_base_vel_.angular.z > 0 ? vel_ang_max_ : - vel_ang_max_);
+                else
+                    velExceeded=true;
+            }
 
 
-                current_base_vel_.linear.y = pid_y_.computeCommand(err_y_r, ros::Duration(time_step_));
+        }
 
-                if(fabs(current_base_vel_.linear.y) > vel_y_max_) {
-                    if(gotoCommand)
-                        current_base_vel_.linear.y = (current_base_vel_.linear.y > 0 ? vel_y_max_ : - vel_y_max_);
-                    else
-                        velExceeded=true;
 
-                }
+        double err_x_odom = std::isnan(goal.position[0]) == 0  ? goal.position[0] - currentPose.x : 0;
+        double err_y_odom = std::isnan(goal.position[1]) == 0  ? goal.position[1] - currentPose.y : 0;
 
-                if (!velExceeded)
-                    pubMove.publish(current_base_vel_);
-                else
-		  cout << " Base velocity exceeded the limit" << endl;
 
-		if ((fabs(err_x_odom) < TOLERANCE) && (fabs(err_y_odom) < TOLERANCE) && (fabs(orient_error) < TOLERANCE)) {
-			start_move_base_ = false;
-		} 
-            }
+        double err_x_r = cos_theta * err_x_odom + sin_theta * err_y_odom;
+        double err_y_r = -sin_theta * err_x_odom + cos_theta * err_y_odom;
+        double ff_x_r = cos_theta * feed_forward[0] + sin_theta * feed_forward[1];
+        double ff_y_r = -sin_theta * feed_forward[0] + cos_theta * feed_forward[1];
+        current_base_vel_.linear.x = ff_x_r + pid_x_.computeCommand(err_x_r, ros::Duration(dt));
+        if(fabs(current_base_vel_.linear.x) > vel_x_max_) {
+            if (clamp)
+                current_base_vel_.linear.x= (current_base_vel_.linear.x > 0 ? vel_x_max_ : - vel_x_max_);
+            else
+                velExceeded=true;
+        }
+
 
-            moveBaseRate.sleep();
+        current_base_vel_.linear.y = ff_y_r + pid_y_.computeCommand(err_y_r, ros::Duration(dt));
+
+        if(fabs(current_base_vel_.linear.y) > vel_y_max_) {
+            if(clamp)
+                current_base_vel_.linear.y = (current_base_vel_.linear.y > 0 ? vel_y_max_ : - vel_y_max_);
+            else
+                velExceeded=true;
 
         }
 
+        if (!velExceeded)
+            pubMove.publish(current_base_vel_);
+        else
+          cout << " Base velocity exceeded the limit" << endl;
+
+        // a setpoint that is still moving is never reached, the base would keep the last twist
+        return !moving && (fabs(err_x_odom) < TOLERANCE) && (fabs(err_y_odom) < TOLERANCE) && (fabs(orient_error) < TOLERANCE);
+
     }
 
     geometry_msgs::Twist BaseController::getNullTwist() {
@@ -228,19 +324,17 @@ namespace squirrel_control {
         return err_th;
     }
 
-    std::vector<double> BaseController::getCurrentState() {
-        std::vector<double> states;
-        robot_pose_mutex_.lock();
-        geometry_msgs::Quaternion odomBkp = odometry.pose.pose.orientation;
-        tf::Quaternion quat(odomBkp.x,odomBkp.y,odomBkp.z,odomBkp.w);
-        quat.normalize();
-
-        states.push_back(odometry.pose.pose.position.x);
-        states.push_back(odometry.pose.pose.position.y);
-        states.push_back(tf::getYaw(quat));
-        robot_pose_mutex_.unlock();
+    BasePose BaseController::getCurrentPose() {
+        boost::lock_guard<boost::mutex> lock(state_mutex_);
+        return pose_;
+    }
 
+    std::vector<double> BaseController::getCurrentState() {
+        BasePose pose = getCurrentPose();
+        std::vector<double> states(3);
+        states[0] = pose.x;
+        states[1] = pose.y;
+        states[2] = pose.theta;
         return states;
-
     }
 }
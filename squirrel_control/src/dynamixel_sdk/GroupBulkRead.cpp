@@ -12,6 +12,14 @@
 #include <algorithm>
 #include <dynamixel_sdk/GroupBulkRead.h>
 
+#define RXPACKET_MAX_LEN    (4*1024)
+
+// Protocol 2.0 status packet layout (see Protocol2PacketHandler.cpp)
+#define PKT_ID                  4
+#define PKT_LENGTH_L            5
+#define PKT_LENGTH_H            6
+#define PKT_ERROR               8
+
 using namespace ROBOTIS;
 
 GroupBulkRead::GroupBulkRead(PortHandler *port, PacketHandler *ph)
@@ -19,7 +27,8 @@ GroupBulkRead::GroupBulkRead(PortHandler *port, PacketHandler *ph)
       ph_(ph),
       last_result_(false),
       is_param_changed_(false),
-      param_(0)
+      param_(0),
+      rxpacket_(new UINT8_T[RXPACKET_MAX_LEN])
 {
     ClearParam();
 }
@@ -68,6 +77,7 @@ bool GroupBulkRead::AddParam(UINT8_T id, UINT16_T start_address, UINT16_T data_l
     length_list_[id]    = data_length;
     address_list_[id]   = start_address;
     data_list_[id]      = new UINT8_T[data_length];
+    result_list_[id]    = COMM_NOT_AVAILABLE;
 
     is_param_changed_   = true;
     return true;
@@ -84,6 +94,7 @@ void GroupBulkRead::RemoveParam(UINT8_T id)
     length_list_.erase(id);
     delete[] data_list_[id];
     data_list_.erase(id);
+    result_list_.erase(id);
 
     is_param_changed_   = true;
 }
@@ -100,6 +111,7 @@ void GroupBulkRead::ClearParam()
     address_list_.clear();
     length_list_.clear();
     data_list_.clear();
+    result_list_.clear();
     if(param_ != 0)
         delete[] param_;
     param_ = 0;
@@ -113,6 +125,9 @@ int GroupBulkRead::TxPacket()
     if(is_param_changed_ == true)
         MakeParam();
 
+    for(unsigned int _i = 0; _i < id_list_.size(); _i++)
+        result_list_[id_list_[_i]] = COMM_RX_WAITING;
+
     if(ph_->GetProtocolVersion() == 1.0)
         return ph_->BulkReadTx(port_, param_, id_list_.size() * 3);
     else    // 2.0
@@ -122,29 +137,76 @@ int GroupBulkRead::TxPacket()
 int GroupBulkRead::RxPacket()
 {
     int _cnt            = id_list_.size();
-    int _result         = COMM_RX_FAIL;
+    int _result         = COMM_SUCCESS;
 
     last_result_ = false;
 
     if(_cnt == 0)
         return COMM_NOT_AVAILABLE;
 
+    // Protocol 1.0 status packets carry no length to check, they are read in the order of the request
+    if(ph_->GetProtocolVersion() == 1.0)
+    {
+        for(int _i = 0; _i < _cnt; _i++)
+        {
+            UINT8_T _id = id_list_[_i];
+
+            _result = ph_->ReadRx(port_, length_list_[_id], data_list_[_id]);
+            result_list_[_id] = _result;
+            if(_result != COMM_SUCCESS)
+            {
+                fprintf(stderr, "[GroupBulkRead::RxPacket] ID %d result : %d !!!!!!!!!!\n", _id, _result);
+                return _result;
+            }
+        }
+        last_result_ = true;
+        return _result;
+    }
+
+    for(int _i = 0; _i < _cnt; _i++)
+        result_list_[id_list_[_i]] = COMM_RX_TIMEOUT;
+
+    // Same as GroupSyncRead: status packets are matched by their ID, and as every servo answers with
+    // its own address range, their length is checked against the range requested from that ID.
     for(int _i = 0; _i < _cnt; _i++)
     {
-        UINT8_T _id = id_list_[_i];
+        int _rx_result = ph_->RxPacket(port_, rxpacket_);
+        if(_rx_result != COMM_SUCCESS)
+        {
+            _result = _rx_result;
+            continue;
+        }
+
+        UINT8_T _id = rxpacket_[PKT_ID];
+        std::map<UINT8_T, UINT8_T *>::iterator it = data_list_.find(_id);
+        if(it == data_list_.end())
+            continue;
 
-        _result = ph_->ReadRx(port_, length_list_[_id], data_list_[_id]);
-        if(_result != COMM_SUCCESS)
+        // 4: INST ERROR CRC16_L CRC16_H
+        UINT16_T _data_length = length_list_[_id];
+        if(DXL_MAKEWORD(rxpacket_[PKT_LENGTH_L], rxpacket_[PKT_LENGTH_H]) < _data_length + 4)
         {
-            fprintf(stderr, "[GroupBulkRead::RxPacket] ID %d result : %d !!!!!!!!!!\n", _id, _result);
-            return _result;
+            result_list_[_id] = COMM_RX_CORRUPT;
+            continue;
         }
+
+        for(UINT16_T _s = 0; _s < _data_length; _s++)
+            it->second[_s] = rxpacket_[PKT_ERROR + 1 + _s];
+        result_list_[_id] = COMM_SUCCESS;
     }
 
-    if(_result == COMM_SUCCESS)
-        last_result_ = true;
+    for(int _i = 0; _i < _cnt; _i++)
+    {
+        if(result_list_[id_list_[_i]] != COMM_SUCCESS)
+        {
+            if(_result == COMM_SUCCESS)
+                _result = COMM_RX_FAIL;
+            return _result;
+        }
+    }
 
-    return _result;
+    last_result_ = true;
+    return COMM_SUCCESS;
 }
 
 int GroupBulkRead::TxRxPacket()
@@ -162,7 +224,7 @@ bool GroupBulkRead::IsAvailable(UINT8_T id, UINT16_T address, UINT16_T data_leng
 {
     UINT16_T _start_addr, _data_length;
 
-    if(last_result_ == false || data_list_.find(id) == data_list_.end())
+    if(GetResult(id) != COMM_SUCCESS)
         return false;
 
     _start_addr = address_list_[id];
@@ -174,6 +236,15 @@ bool GroupBulkRead::IsAvailable(UINT8_T id, UINT16_T address, UINT16_T data_leng
     return true;
 }
 
+int GroupBulkRead::GetResult(UINT8_T id)
+{
+    std::map<UINT8_T, int>::iterator it = result_list_.find(id);
+    if(it == result_list_.end())
+        return COMM_NOT_AVAILABLE;
+
+    return it->second;
+}
+
 UINT32_T GroupBulkRead::GetData(UINT8_T id, UINT16_T address, UINT16_T data_length)
 {
     if(IsAvailable(id, address, data_length) == false)
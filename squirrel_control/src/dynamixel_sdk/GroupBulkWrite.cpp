@@ -100,9 +100,13 @@ bool GroupBulkWrite::ChangeParam(UINT8_T id, UINT16_T start_address, UINT16_T da
         return false;
 
     address_list_[id] = start_address;
-    length_list_[id] = data_length;
-    delete[] data_list_[id];
-    data_list_[id] = new UINT8_T[data_length];
+    // the data buffer is only reallocated if the length of the id changes
+    if(length_list_[id] != data_length)
+    {
+        length_list_[id] = data_length;
+        delete[] data_list_[id];
+        data_list_[id] = new UINT8_T[data_length];
+    }
     for(int _c = 0; _c < data_length; _c++)
         data_list_[id][_c] = data[_c];
 
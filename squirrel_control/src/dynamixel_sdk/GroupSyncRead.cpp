@@ -11,6 +11,14 @@
 #include <algorithm>
 #include <dynamixel_sdk/GroupSyncRead.h>
 
+#define RXPACKET_MAX_LEN    (4*1024)
+
+// Protocol 2.0 status packet layout (see Protocol2PacketHandler.cpp)
+#define PKT_ID                  4
+#define PKT_LENGTH_L            5
+#define PKT_LENGTH_H            6
+#define PKT_ERROR               8
+
 using namespace ROBOTIS;
 
 GroupSyncRead::GroupSyncRead(PortHandler *port, PacketHandler *ph, UINT16_T start_address, UINT16_T data_length)
@@ -20,7 +28,8 @@ GroupSyncRead::GroupSyncRead(PortHandler *port, PacketHandler *ph, UINT16_T star
       is_param_changed_(false),
       param_(0),
       start_address_(start_address),
-      data_length_(data_length)
+      data_length_(data_length),
+      rxpacket_(new UINT8_T[RXPACKET_MAX_LEN])
 {
     ClearParam();
 }
@@ -51,6 +60,7 @@ bool GroupSyncRead::AddParam(UINT8_T id)
 
     id_list_.push_back(id);
     data_list_[id] = new UINT8_T[data_length_];
+    result_list_[id] = COMM_NOT_AVAILABLE;
 
     is_param_changed_   = true;
     return true;
@@ -67,6 +77,7 @@ void GroupSyncRead::RemoveParam(UINT8_T id)
     id_list_.erase(it);
     delete[] data_list_[id];
     data_list_.erase(id);
+    result_list_.erase(id);
 
     is_param_changed_   = true;
 }
@@ -83,6 +94,7 @@ void GroupSyncRead::ClearParam()
 
     id_list_.clear();
     data_list_.clear();
+    result_list_.clear();
     if(param_ != 0)
         delete[] param_;
     param_ = 0;
@@ -96,6 +108,9 @@ int GroupSyncRead::TxPacket()
     if(is_param_changed_ == true)
         MakeParam();
 
+    for(unsigned int _i = 0; _i < id_list_.size(); _i++)
+        result_list_[id_list_[_i]] = COMM_RX_WAITING;
+
     return ph_->SyncReadTx(port_, start_address_, data_length_, param_, (UINT16_T)id_list_.size() * 1);
 }
 
@@ -107,24 +122,54 @@ int GroupSyncRead::RxPacket()
         return COMM_NOT_AVAILABLE;
 
     int _cnt            = id_list_.size();
-    int _result         = COMM_RX_FAIL;
+    int _result         = COMM_SUCCESS;
 
     if(_cnt == 0)
         return COMM_NOT_AVAILABLE;
 
+    for(int _i = 0; _i < _cnt; _i++)
+        result_list_[id_list_[_i]] = COMM_RX_TIMEOUT;
+
+    // Status packets are matched by their ID, so a servo that does not answer only
+    // invalidates its own entry instead of shifting the data of all following servos.
     for(int _i = 0; _i < _cnt; _i++)
     {
-        UINT8_T _id = id_list_[_i];
+        int _rx_result = ph_->RxPacket(port_, rxpacket_);
+        if(_rx_result != COMM_SUCCESS)
+        {
+            _result = _rx_result;
+            continue;
+        }
+
+        UINT8_T _id = rxpacket_[PKT_ID];
+        std::map<UINT8_T, UINT8_T* >::iterator it = data_list_.find(_id);
+        if(it == data_list_.end())
+            continue;
+
+        // 4: INST ERROR CRC16_L CRC16_H
+        if(DXL_MAKEWORD(rxpacket_[PKT_LENGTH_L], rxpacket_[PKT_LENGTH_H]) < data_length_ + 4)
+        {
+            result_list_[_id] = COMM_RX_CORRUPT;
+            continue;
+        }
+
+        for(UINT16_T _s = 0; _s < data_length_; _s++)
+            it->second[_s] = rxpacket_[PKT_ERROR + 1 + _s];
+        result_list_[_id] = COMM_SUCCESS;
+    }
 
-        _result = ph_->ReadRx(port_, data_length_, data_list_[_id]);
-        if(_result != COMM_SUCCESS)
+    for(int _i = 0; _i < _cnt; _i++)
+    {
+        if(result_list_[id_list_[_i]] != COMM_SUCCESS)
+        {
+            if(_result == COMM_SUCCESS)
+                _result = COMM_RX_FAIL;
             return _result;
+        }
     }
 
-    if(_result == COMM_SUCCESS)
-        last_result_ = true;
-
-    return _result;
+    last_result_ = true;
+    return COMM_SUCCESS;
 }
 
 int GroupSyncRead::TxRxPacket()
@@ -143,7 +188,7 @@ int GroupSyncRead::TxRxPacket()
 
 bool GroupSyncRead::IsAvailable(UINT8_T id, UINT16_T address, UINT16_T data_length)
 {
-    if(ph_->GetProtocolVersion() == 1.0 || last_result_ == false || data_list_.find(id) == data_list_.end())
+    if(ph_->GetProtocolVersion() == 1.0 || GetResult(id) != COMM_SUCCESS)
         return false;
 
     if(address < start_address_ || start_address_ + data_length_ - data_length < address)
@@ -152,6 +197,15 @@ bool GroupSyncRead::IsAvailable(UINT8_T id, UINT16_T address, UINT16_T data_leng
     return true;
 }
 
+int GroupSyncRead::GetResult(UINT8_T id)
+{
+    std::map<UINT8_T, int>::iterator it = result_list_.find(id);
+    if(it == result_list_.end())
+        return COMM_NOT_AVAILABLE;
+
+    return it->second;
+}
+
 UINT32_T GroupSyncRead::GetData(UINT8_T id, UINT16_T address, UINT16_T data_length)
 {
     if(IsAvailable(id, address, data_length) == false)
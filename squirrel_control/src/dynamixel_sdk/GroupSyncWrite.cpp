@@ -81,8 +81,7 @@ bool GroupSyncWrite::ChangeParam(UINT8_T id, UINT8_T *data)
     if(it == id_list_.end())    // NOT exist
         return false;
 
-    delete[] data_list_[id];
-    data_list_[id] = new UINT8_T[data_length_];
+    // the data buffer of an id keeps its size, so it is overwritten in place
     for(int _c = 0; _c < data_length_; _c++)
         data_list_[id][_c] = data[_c];
 
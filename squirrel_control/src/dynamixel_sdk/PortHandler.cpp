@@ -8,7 +8,9 @@
 #define WINDLLEXPORT
 #endif
 
+#include <string.h>
 #include <dynamixel_sdk/PortHandler.h>
+#include <dynamixel_sdk/PortHandlerSim.h>
 
 #ifdef __linux__
   #include <dynamixel_sdk/PortHandlerLinux.h>
@@ -22,6 +24,10 @@ using namespace ROBOTIS;
 
 PortHandler *PortHandler::GetPortHandler(const char *port_name)
 {
+    // simulated bus, see PortHandlerSim.h
+    if(strncmp(port_name, "sim:", 4) == 0)
+        return (PortHandler *)(new PortHandlerSim(port_name));
+
 #ifdef __linux__
     return (PortHandler *)(new PortHandlerLinux(port_name));
 #endif
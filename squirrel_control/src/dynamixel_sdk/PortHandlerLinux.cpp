@@ -6,9 +6,13 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
+#include <poll.h>
+#include <math.h>
 #include <termios.h>
 #include <time.h>
 #include <sys/time.h>
@@ -17,7 +21,8 @@
 
 #include <dynamixel_sdk/PortHandlerLinux.h>
 
-#define LATENCY_TIMER   4  // msec (USB latency timer)
+#define LATENCY_TIMER   4  // msec (USB latency timer), used when the adapter does not report its own
+#define LOW_LATENCY_TIMER   1  // msec, requested from the adapter in low latency mode
 
 using namespace ROBOTIS;
 
@@ -26,7 +31,10 @@ PortHandlerLinux::PortHandlerLinux(const char *port_name)
       baudrate_(DEFAULT_BAUDRATE),
       packet_start_time_(0.0),
       packet_timeout_(0.0),
-      tx_time_per_byte(0.0)
+      tx_time_per_byte(0.0),
+      blocking_read_(false),
+      low_latency_(false),
+      latency_timer_(LATENCY_TIMER)
 {
     is_using = false;
     SetPortName(port_name);
@@ -92,6 +100,22 @@ int PortHandlerLinux::GetBytesAvailable()
 
 int PortHandlerLinux::ReadPort(UINT8_T *packet, int length)
 {
+    int _result = read(socket_fd_, packet, length);
+    if(_result > 0 || blocking_read_ == false || packet_timeout_ <= 0.0)
+        return _result;
+
+    // nothing received yet: sleep until the port becomes readable or the packet deadline passes
+    int _wait_msec = (int)ceil(packet_timeout_ - GetTimeSinceStart());
+    if(_wait_msec <= 0)
+        return _result;
+
+    struct pollfd _pfd;
+    _pfd.fd      = socket_fd_;
+    _pfd.events  = POLLIN;
+    _pfd.revents = 0;
+    if(poll(&_pfd, 1, _wait_msec) <= 0)
+        return 0;
+
     return read(socket_fd_, packet, length);
 }
 
@@ -103,7 +127,7 @@ int PortHandlerLinux::WritePort(UINT8_T *packet, int length)
 void PortHandlerLinux::SetPacketTimeout(UINT16_T packet_length)
 {
     packet_start_time_  = GetCurrentTime();
-    packet_timeout_     = (tx_time_per_byte * (double)packet_length) + (LATENCY_TIMER * 2.0) + 2.0;
+    packet_timeout_     = (tx_time_per_byte * (double)packet_length) + (latency_timer_ * 2.0) + 2.0;
 }
 
 void PortHandlerLinux::SetPacketTimeout(double msec)
@@ -112,6 +136,16 @@ void PortHandlerLinux::SetPacketTimeout(double msec)
     packet_timeout_     = msec;
 }
 
+void PortHandlerLinux::SetBlockingRead(bool enable)
+{
+    blocking_read_ = enable;
+}
+
+void PortHandlerLinux::SetLowLatency(bool enable)
+{
+    low_latency_ = enable;
+}
+
 bool PortHandlerLinux::IsPacketTimeout()
 {
     if(GetTimeSinceStart() > packet_timeout_)
@@ -125,7 +159,7 @@ bool PortHandlerLinux::IsPacketTimeout()
 double PortHandlerLinux::GetCurrentTime()
 {
 	struct timespec _tv;
-	clock_gettime( CLOCK_REALTIME, &_tv);
+	clock_gettime( CLOCK_MONOTONIC, &_tv);
 	return ((double)_tv.tv_sec*1000.0 + (double)_tv.tv_nsec*0.001*0.001);
 }
 
@@ -165,9 +199,85 @@ bool PortHandlerLinux::SetupPort(int cflag_baud)
     tcsetattr(socket_fd_, TCSANOW, &newtio);
 
     tx_time_per_byte = (1000.0 / (double)baudrate_) * 10.0;
+
+    if(low_latency_)
+        SetupLowLatency();
+
+    // packet timeouts have to cover the time the adapter holds back received bytes
+    int _latency_timer = ReadLatencyTimer();
+    latency_timer_ = (_latency_timer > 0) ? _latency_timer : LATENCY_TIMER;
     return true;
 }
 
+bool PortHandlerLinux::SetupLowLatency()
+{
+    struct serial_struct ss;
+    if(ioctl(socket_fd_, TIOCGSERIAL, &ss) != 0)
+    {
+        printf("[PortHandlerLinux::SetupLowLatency] TIOCGSERIAL failed!\n");
+        return false;
+    }
+
+    ss.flags |= ASYNC_LOW_LATENCY;
+    if(ioctl(socket_fd_, TIOCSSERIAL, &ss) < 0)
+    {
+        printf("[PortHandlerLinux::SetupLowLatency] TIOCSSERIAL failed!\n");
+        return false;
+    }
+
+    // recent ftdi_sio drivers ignore ASYNC_LOW_LATENCY, the latency timer has to be set through sysfs
+    int _latency_timer = ReadLatencyTimer();
+    if(_latency_timer > LOW_LATENCY_TIMER && WriteLatencyTimer(LOW_LATENCY_TIMER) == false)
+        printf("[PortHandlerLinux::SetupLowLatency] Cannot set latency timer of %s to %d msec, it stays at %d msec\n",
+               port_name_, LOW_LATENCY_TIMER, _latency_timer);
+    return true;
+}
+
+bool PortHandlerLinux::GetLatencyTimerPath(char *path, int length)
+{
+    // the port name is usually a udev symlink, sysfs knows the device by its kernel name
+    char _device[PATH_MAX];
+    if(realpath(port_name_, _device) == 0)
+        return false;
+
+    const char *_name = strrchr(_device, '/');
+    _name = (_name == 0) ? _device : _name + 1;
+    return snprintf(path, length, "/sys/bus/usb-serial/devices/%s/latency_timer", _name) < length;
+}
+
+int PortHandlerLinux::ReadLatencyTimer()
+{
+    char _path[PATH_MAX];
+    if(GetLatencyTimerPath(_path, sizeof(_path)) == false)
+        return -1;
+
+    FILE *_file = fopen(_path, "r");
+    if(_file == 0)
+        return -1;
+
+    int _msec = -1;
+    if(fscanf(_file, "%d", &_msec) != 1)
+        _msec = -1;
+    fclose(_file);
+    return _msec;
+}
+
+bool PortHandlerLinux::WriteLatencyTimer(int msec)
+{
+    char _path[PATH_MAX];
+    if(GetLatencyTimerPath(_path, sizeof(_path)) == false)
+        return false;
+
+    FILE *_file = fopen(_path, "w");
+    if(_file == 0)
+        return false;
+
+    bool _result = fprintf(_file, "%d", msec) > 0;
+    if(fclose(_file) != 0)
+        _result = false;
+    return _result;
+}
+
 bool PortHandlerLinux::SetCustomBaudrate(int speed)
 {
     // try to set a custom divisor
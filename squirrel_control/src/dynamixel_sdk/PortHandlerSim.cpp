@@ -0,0 +1,667 @@
+/*
+ * PortHandlerSim.cpp
+ *
+ *  In-process Dynamixel Protocol 2.0 bus for running the driver without motors, see PortHandlerSim.h
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <limits>
+
+#include <dynamixel_sdk/PortHandlerSim.h>
+#include <dynamixel_sdk/PacketHandler.h>
+
+#define PORT_NAME_PREFIX        "sim:"
+
+#define PKT_ID                  4
+#define PKT_LENGTH_L            5
+#define PKT_LENGTH_H            6
+#define PKT_INSTRUCTION         7
+#define PKT_PARAMETER0          8
+
+#define ERRNUM_INSTRUCTION      2
+#define ERRNUM_ACCESS           7
+
+#define DEFAULT_LATENCY_TIMER   1.0     // msec, what PortHandlerLinux sets up in low latency mode
+#define DEFAULT_TEMPERATURE     30      // degree Celsius
+
+using namespace ROBOTIS;
+
+// bitwise on purpose, the packet handler's table driven CRC is checked against it
+static UINT16_T UpdateCRC(UINT16_T crc_accum, const UINT8_T *data_blk_ptr, size_t data_blk_size)
+{
+    for(size_t _i = 0; _i < data_blk_size; _i++)
+    {
+        crc_accum ^= (UINT16_T)data_blk_ptr[_i] << 8;
+        for(int _bit = 0; _bit < 8; _bit++)
+            crc_accum = (crc_accum & 0x8000) ? (UINT16_T)((crc_accum << 1) ^ 0x8005) : (UINT16_T)(crc_accum << 1);
+    }
+    return crc_accum;
+}
+
+static bool IsNumber(const std::string &text)
+{
+    if(text.empty())
+        return false;
+    for(size_t _i = 0; _i < text.size(); _i++)
+    {
+        if(!isdigit((unsigned char)text[_i]))
+            return false;
+    }
+    return true;
+}
+
+/* SimulatedDevice */
+
+SimulatedDevice::SimulatedDevice(UINT8_T id, dynamixel_tool::DynamixelTool *tool)
+    : id_(id),
+      tool_(tool),
+      position_(tool->value_of_0_radian_position_),
+      last_update_(-1.0),
+      indirect_count_(0)
+{
+    size_t _table_size = 0;
+    for(std::map<std::string, dynamixel_tool::ControlTableItem *>::iterator _it = tool_->ctrl_table_.begin(); _it != tool_->ctrl_table_.end(); ++_it)
+        _table_size = std::max<size_t>(_table_size, _it->second->address + _it->second->data_length);
+    table_.assign(_table_size, 0);
+
+    // the indirect addresses run up to the next item of the control table
+    dynamixel_tool::ControlTableItem *_indirect_address = tool_->items_.indirect_address_1;
+    if(_indirect_address && tool_->items_.indirect_data_1)
+    {
+        UINT16_T _end = table_.size();
+        for(std::map<std::string, dynamixel_tool::ControlTableItem *>::iterator _it = tool_->ctrl_table_.begin(); _it != tool_->ctrl_table_.end(); ++_it)
+        {
+            if(_it->second->address > _indirect_address->address)
+                _end = std::min<UINT16_T>(_end, _it->second->address);
+        }
+        indirect_count_ = (_end - _indirect_address->address) / 2;
+    }
+
+    SetValue(tool_->findItem("model_number"), tool_->model_number_);
+    SetValue(tool_->findItem("id"), id_);
+    SetValue(tool_->items_.operating_mode, 3);
+    SetValue(tool_->items_.present_position, tool_->value_of_0_radian_position_);
+    SetValue(tool_->items_.present_temperature, DEFAULT_TEMPERATURE);
+    // the simulated motors do not limit anything
+    SetValue(tool_->items_.velocity_limit, tool_->items_.velocity_limit && tool_->items_.velocity_limit->data_length == 2 ?
+             std::numeric_limits<INT16_T>::max() : std::numeric_limits<INT32_T>::max());
+    SetValue(tool_->items_.torque_limit, tool_->items_.torque_limit && tool_->items_.torque_limit->data_length == 2 ?
+             std::numeric_limits<INT16_T>::max() : std::numeric_limits<INT32_T>::max());
+}
+
+SimulatedDevice::~SimulatedDevice()
+{
+    delete tool_;
+}
+
+UINT16_T SimulatedDevice::GetReturnDelayTime()
+{
+    // 2 usec per unit
+    return GetValue(tool_->findItem("return_delay_time")) * 2;
+}
+
+UINT16_T SimulatedDevice::MapAddress(UINT16_T address)
+{
+    dynamixel_tool::ControlTableItem *_indirect_data = tool_->items_.indirect_data_1;
+    if(indirect_count_ == 0 || address < _indirect_data->address || address >= _indirect_data->address + indirect_count_)
+        return address;
+
+    UINT16_T _entry = tool_->items_.indirect_address_1->address + 2 * (address - _indirect_data->address);
+    return DXL_MAKEWORD(table_[_entry], table_[_entry + 1]);
+}
+
+bool SimulatedDevice::Read(UINT16_T address, UINT16_T length, UINT8_T *data)
+{
+    for(UINT16_T _i = 0; _i < length; _i++)
+    {
+        UINT16_T _address = MapAddress(address + _i);
+        if(_address >= table_.size())
+            return false;
+        data[_i] = table_[_address];
+    }
+    return true;
+}
+
+bool SimulatedDevice::Write(UINT16_T address, UINT16_T length, const UINT8_T *data)
+{
+    for(UINT16_T _i = 0; _i < length; _i++)
+    {
+        if(MapAddress(address + _i) >= table_.size())
+            return false;
+    }
+    for(UINT16_T _i = 0; _i < length; _i++)
+        table_[MapAddress(address + _i)] = data[_i];
+    return true;
+}
+
+INT32_T SimulatedDevice::GetValue(dynamixel_tool::ControlTableItem *item)
+{
+    if(item == NULL)
+        return 0;
+
+    UINT32_T _value = 0;
+    for(int _i = item->data_length - 1; _i >= 0; _i--)
+        _value = (_value << 8) | table_[item->address + _i];
+
+    switch(item->data_length)
+    {
+    case 1:
+        return (INT32_T)(UINT8_T)_value;
+    case 2:
+        return (INT16_T)_value;
+    default:
+        return (INT32_T)_value;
+    }
+}
+
+void SimulatedDevice::SetValue(dynamixel_tool::ControlTableItem *item, INT32_T value)
+{
+    if(item == NULL)
+        return;
+
+    UINT32_T _value = (UINT32_T)value;
+    for(int _i = 0; _i < item->data_length; _i++)
+    {
+        table_[item->address + _i] = (UINT8_T)(_value & 0xFF);
+        _value >>= 8;
+    }
+}
+
+void SimulatedDevice::Update(double time)
+{
+    double _elapsed = last_update_ < 0.0 ? 0.0 : (time - last_update_) * 0.001;
+    last_update_ = time;
+
+    dynamixel_tool::ControlTableItems &_items = tool_->items_;
+    INT32_T _velocity = 0;
+    INT32_T _current = 0;
+    if(GetValue(_items.torque_enable) != 0)
+    {
+        switch(GetValue(_items.operating_mode))
+        {
+        case 0:     // torque / current
+            _current = GetValue(_items.goal_torque);
+            break;
+
+        case 1:     // velocity, the goal is reached immediately
+            _velocity = GetValue(_items.goal_velocity);
+            // ticks per radian are counted from the zero position, e.g. 2048 on the X series
+            if(tool_->velocity_to_value_ratio_ > 0 && tool_->max_radian_ != 0)
+                position_ += _velocity / tool_->velocity_to_value_ratio_ * _elapsed *
+                             (tool_->value_of_max_radian_position_ - tool_->value_of_0_radian_position_) / tool_->max_radian_;
+            break;
+
+        case 3:     // position, the goal is reached immediately
+            position_ = GetValue(_items.goal_position);
+            break;
+
+        default:
+            break;
+        }
+    }
+    position_ = std::max<double>(tool_->value_of_min_radian_position_, std::min<double>(tool_->value_of_max_radian_position_, position_));
+
+    SetValue(_items.present_position, (INT32_T)round(position_));
+    SetValue(_items.present_velocity, _velocity);
+    SetValue(_items.present_current, _current);
+}
+
+/* PortHandlerSim */
+
+PortHandlerSim::PortHandlerSim(const char *port_name)
+    : baudrate_(DEFAULT_BAUDRATE),
+      packet_start_time_(0.0),
+      packet_timeout_(0.0),
+      tx_time_per_byte(0.0),
+      blocking_read_(false),
+      latency_timer_(DEFAULT_LATENCY_TIMER),
+      byte_time_(0.0),
+      drop_rate_(0.0),
+      corrupt_rate_(0.0),
+      seed_(1)
+{
+    is_using = false;
+    SetPortName(port_name);
+    ParsePortName(port_name);
+}
+
+PortHandlerSim::~PortHandlerSim()
+{
+    ClosePort();
+    for(size_t _i = 0; _i < devices_.size(); _i++)
+        delete devices_[_i];
+}
+
+bool PortHandlerSim::ParsePortName(const char *port_name)
+{
+    std::string _spec(port_name);
+    if(_spec.compare(0, strlen(PORT_NAME_PREFIX), PORT_NAME_PREFIX) == 0)
+        _spec = _spec.substr(strlen(PORT_NAME_PREFIX));
+
+    bool _result = true;
+    size_t _start = 0;
+    while(_start < _spec.size())
+    {
+        size_t _end = _spec.find(',', _start);
+        if(_end == std::string::npos)
+            _end = _spec.size();
+        std::string _token = _spec.substr(_start, _end - _start);
+        _start = _end + 1;
+
+        size_t _separator = _token.find('=');
+        if(_separator == std::string::npos)
+        {
+            printf("[PortHandlerSim::ParsePortName] Ignoring \"%s\", expected <id>=<model> or <option>=<value>\n", _token.c_str());
+            _result = false;
+            continue;
+        }
+        std::string _key = _token.substr(0, _separator);
+        std::string _value = _token.substr(_separator + 1);
+
+        if(IsNumber(_key))
+            _result = AddDevice((UINT8_T)atoi(_key.c_str()), _value) && _result;
+        else if(_key == "latency")
+            SetLatencyTimer(atof(_value.c_str()));
+        else if(_key == "byte_time")
+            SetByteTime(atof(_value.c_str()) * 0.001);
+        else if(_key == "drop")
+            SetDropRate(atof(_value.c_str()));
+        else if(_key == "corrupt")
+            SetCorruptRate(atof(_value.c_str()));
+        else if(_key == "seed")
+            SetSeed((unsigned int)atoi(_value.c_str()));
+        else
+        {
+            printf("[PortHandlerSim::ParsePortName] Unknown option \"%s\"\n", _key.c_str());
+            _result = false;
+        }
+    }
+    return _result;
+}
+
+bool PortHandlerSim::AddDevice(UINT8_T id, const std::string &model)
+{
+    if(id > MAX_ID || FindDevice(id) != NULL)
+    {
+        printf("[PortHandlerSim::AddDevice] Invalid or duplicate id %d\n", id);
+        return false;
+    }
+
+    dynamixel_tool::DynamixelTool *_tool = NULL;
+    try
+    {
+        if(IsNumber(model))
+            _tool = new dynamixel_tool::DynamixelTool(id, (uint16_t)atoi(model.c_str()), 2.0);
+        else
+            _tool = new dynamixel_tool::DynamixelTool(id, model, 2.0);
+    }
+    catch(std::exception &ex)
+    {
+        printf("[PortHandlerSim::AddDevice] Unknown model %s: %s\n", model.c_str(), ex.what());
+        return false;
+    }
+
+    // broadcast answers come in the order of the ids
+    std::vector<SimulatedDevice *>::iterator _it = devices_.begin();
+    while(_it != devices_.end() && (*_it)->GetID() < id)
+        ++_it;
+    devices_.insert(_it, new SimulatedDevice(id, _tool));
+    return true;
+}
+
+SimulatedDevice *PortHandlerSim::FindDevice(UINT8_T id)
+{
+    for(size_t _i = 0; _i < devices_.size(); _i++)
+    {
+        if(devices_[_i]->GetID() == id)
+            return devices_[_i];
+    }
+    return NULL;
+}
+
+bool PortHandlerSim::OpenPort()
+{
+    return SetBaudRate(baudrate_);
+}
+
+void PortHandlerSim::ClosePort()
+{
+    ClearPort();
+}
+
+void PortHandlerSim::ClearPort()
+{
+    tx_buffer_.clear();
+    rx_buffer_.clear();
+}
+
+void PortHandlerSim::SetPortName(const char *port_name)
+{
+    strncpy(port_name_, port_name, sizeof(port_name_) - 1);
+    port_name_[sizeof(port_name_) - 1] = '\0';
+}
+
+char *PortHandlerSim::GetPortName()
+{
+    return port_name_;
+}
+
+bool PortHandlerSim::SetBaudRate(const int baudrate)
+{
+    if(baudrate <= 0)
+        return false;
+    baudrate_ = baudrate;
+    tx_time_per_byte = (1000.0 / (double)baudrate_) * 10.0;
+    return true;
+}
+
+int PortHandlerSim::GetBaudRate()
+{
+    return baudrate_;
+}
+
+double PortHandlerSim::GetByteTime()
+{
+    return byte_time_ > 0.0 ? byte_time_ : tx_time_per_byte;
+}
+
+bool PortHandlerSim::Happens(double probability)
+{
+    return probability > 0.0 && (double)rand_r(&seed_) / RAND_MAX < probability;
+}
+
+int PortHandlerSim::GetBytesAvailable()
+{
+    double _now = GetCurrentTime();
+    int _available = 0;
+    for(std::deque<RxByte>::iterator _it = rx_buffer_.begin(); _it != rx_buffer_.end() && _it->visible_time <= _now; ++_it)
+        _available++;
+    return _available;
+}
+
+int PortHandlerSim::ReadPort(UINT8_T *packet, int length)
+{
+    if(blocking_read_ && GetBytesAvailable() == 0)
+    {
+        // sleep until the next byte arrives or the packet times out, like poll() on a serial port
+        double _wait = packet_start_time_ + packet_timeout_;
+        if(!rx_buffer_.empty())
+            _wait = std::min(_wait, rx_buffer_.front().visible_time);
+        _wait -= GetCurrentTime();
+        if(_wait > 0.0)
+        {
+            struct timespec _sleep;
+            _sleep.tv_sec = (time_t)(_wait * 0.001);
+            _sleep.tv_nsec = (long)((_wait - _sleep.tv_sec * 1000.0) * 1000000.0);
+            nanosleep(&_sleep, NULL);
+        }
+    }
+
+    double _now = GetCurrentTime();
+    int _read = 0;
+    while(_read < length && !rx_buffer_.empty() && rx_buffer_.front().visible_time <= _now)
+    {
+        packet[_read++] = rx_buffer_.front().data;
+        rx_buffer_.pop_front();
+    }
+    return _read;
+}
+
+int PortHandlerSim::WritePort(UINT8_T *packet, int length)
+{
+    double _now = GetCurrentTime();
+    tx_buffer_.insert(tx_buffer_.end(), packet, packet + length);
+
+    while(tx_buffer_.size() >= PKT_PARAMETER0)
+    {
+        // skip to the next header
+        if(tx_buffer_[0] != 0xFF || tx_buffer_[1] != 0xFF || tx_buffer_[2] != 0xFD || tx_buffer_[3] != 0x00)
+        {
+            tx_buffer_.erase(tx_buffer_.begin());
+            continue;
+        }
+        size_t _total_length = DXL_MAKEWORD(tx_buffer_[PKT_LENGTH_L], tx_buffer_[PKT_LENGTH_H]) + PKT_INSTRUCTION;
+        if(tx_buffer_.size() < _total_length)
+            break;
+
+        std::vector<UINT8_T> _packet(tx_buffer_.begin(), tx_buffer_.begin() + _total_length);
+        tx_buffer_.erase(tx_buffer_.begin(), tx_buffer_.begin() + _total_length);
+
+        // a packet with a wrong CRC is ignored by the devices
+        if(UpdateCRC(0, _packet.data(), _total_length - 2) != DXL_MAKEWORD(_packet[_total_length - 2], _packet[_total_length - 1]))
+            continue;
+
+        // the instruction reaches the devices once it is completely on the bus
+        HandlePacket(_packet, _now + _total_length * GetByteTime());
+    }
+    return length;
+}
+
+void PortHandlerSim::HandlePacket(std::vector<UINT8_T> &packet, double time)
+{
+    // remove byte stuffing and CRC, leaving the parameters
+    std::vector<UINT8_T> _params;
+    for(size_t _i = PKT_PARAMETER0; _i < packet.size() - 2; _i++)
+    {
+        _params.push_back(packet[_i]);
+        size_t _n = _params.size();
+        // the FD following an FF FF FD of the data is stuffing
+        if(_n >= 3 && _params[_n - 3] == 0xFF && _params[_n - 2] == 0xFF && _params[_n - 1] == 0xFD &&
+           _i + 1 < packet.size() - 2 && packet[_i + 1] == 0xFD)
+            _i++;
+    }
+    UINT8_T _id = packet[PKT_ID];
+    UINT8_T _instruction = packet[PKT_INSTRUCTION];
+    size_t _param_length = _params.size();
+    const UINT8_T *_param = _params.data();
+
+    for(size_t _i = 0; _i < devices_.size(); _i++)
+        devices_[_i]->Update(time);
+
+    SimulatedDevice *_device = FindDevice(_id);
+    if(_id != BROADCAST_ID && _device == NULL)
+        return;
+
+    std::vector<UINT8_T> _data;
+    switch(_instruction)
+    {
+    case INST_PING:
+        for(size_t _i = 0; _i < devices_.size(); _i++)
+        {
+            if(_id != BROADCAST_ID && devices_[_i] != _device)
+                continue;
+            UINT8_T _info[3] = { DXL_LOBYTE(devices_[_i]->GetModelNumber()), DXL_HIBYTE(devices_[_i]->GetModelNumber()), 0 };
+            devices_[_i]->Read(6, 1, &_info[2]);    // version_of_firmware
+            time = SendStatus(devices_[_i], 0, _info, 3, time);
+        }
+        break;
+
+    case INST_READ:
+    {
+        if(_device == NULL || _param_length != 4)
+            break;
+        UINT16_T _address = DXL_MAKEWORD(_param[0], _param[1]);
+        UINT16_T _length = DXL_MAKEWORD(_param[2], _param[3]);
+        _data.resize(_length);
+        if(_device->Read(_address, _length, _data.data()))
+            SendStatus(_device, 0, _data.data(), _length, time);
+        else
+            SendStatus(_device, ERRNUM_ACCESS, NULL, 0, time);
+        break;
+    }
+
+    case INST_WRITE:
+    {
+        if(_param_length < 2)
+            break;
+        UINT16_T _address = DXL_MAKEWORD(_param[0], _param[1]);
+        for(size_t _i = 0; _i < devices_.size(); _i++)
+        {
+            if(_id != BROADCAST_ID && devices_[_i] != _device)
+                continue;
+            bool _written = devices_[_i]->Write(_address, _param_length - 2, _param + 2);
+            if(_id != BROADCAST_ID)
+                SendStatus(_device, _written ? 0 : ERRNUM_ACCESS, NULL, 0, time);
+        }
+        break;
+    }
+
+    case INST_SYNC_READ:
+    {
+        if(_param_length < 4)
+            break;
+        UINT16_T _address = DXL_MAKEWORD(_param[0], _param[1]);
+        UINT16_T _length = DXL_MAKEWORD(_param[2], _param[3]);
+        _data.resize(_length);
+        // each device answers after the one listed before it
+        for(size_t _i = 4; _i < _param_length; _i++)
+        {
+            SimulatedDevice *_target = FindDevice(_param[_i]);
+            if(_target != NULL && _target->Read(_address, _length, _data.data()))
+                time = SendStatus(_target, 0, _data.data(), _length, time);
+        }
+        break;
+    }
+
+    case INST_SYNC_WRITE:
+    {
+        if(_param_length < 4)
+            break;
+        UINT16_T _address = DXL_MAKEWORD(_param[0], _param[1]);
+        UINT16_T _length = DXL_MAKEWORD(_param[2], _param[3]);
+        for(size_t _i = 4; _i + 1 + _length <= _param_length; _i += 1 + _length)
+        {
+            SimulatedDevice *_target = FindDevice(_param[_i]);
+            if(_target != NULL)
+                _target->Write(_address, _length, _param + _i + 1);
+        }
+        break;
+    }
+
+    case INST_BULK_READ:
+        for(size_t _i = 0; _i + 5 <= _param_length; _i += 5)
+        {
+            SimulatedDevice *_target = FindDevice(_param[_i]);
+            UINT16_T _address = DXL_MAKEWORD(_param[_i + 1], _param[_i + 2]);
+            UINT16_T _length = DXL_MAKEWORD(_param[_i + 3], _param[_i + 4]);
+            _data.resize(_length);
+            if(_target != NULL && _target->Read(_address, _length, _data.data()))
+                time = SendStatus(_target, 0, _data.data(), _length, time);
+        }
+        break;
+
+    case INST_BULK_WRITE:
+        for(size_t _i = 0; _i + 5 <= _param_length; )
+        {
+            SimulatedDevice *_target = FindDevice(_param[_i]);
+            UINT16_T _address = DXL_MAKEWORD(_param[_i + 1], _param[_i + 2]);
+            UINT16_T _length = DXL_MAKEWORD(_param[_i + 3], _param[_i + 4]);
+            if(_i + 5 + _length > _param_length)
+                break;
+            if(_target != NULL)
+                _target->Write(_address, _length, _param + _i + 5);
+            _i += 5 + _length;
+        }
+        break;
+
+    case INST_REBOOT:
+    case INST_FACTORY_RESET:
+        if(_device != NULL)
+            SendStatus(_device, 0, NULL, 0, time);
+        break;
+
+    default:
+        if(_device != NULL)
+            SendStatus(_device, ERRNUM_INSTRUCTION, NULL, 0, time);
+        break;
+    }
+}
+
+double PortHandlerSim::SendStatus(SimulatedDevice *device, UINT8_T error, const UINT8_T *params, UINT16_T param_length, double time)
+{
+    if(Happens(drop_rate_))
+        return time;
+
+    std::vector<UINT8_T> _packet;
+    UINT8_T _header[PKT_PARAMETER0 + 1] = { 0xFF, 0xFF, 0xFD, 0x00, device->GetID(), 0, 0, INST_STATUS, error };
+    _packet.assign(_header, _header + sizeof(_header));
+    for(UINT16_T _i = 0; _i < param_length; _i++)
+    {
+        _packet.push_back(params[_i]);
+        size_t _n = _packet.size();
+        if(_packet[_n - 3] == 0xFF && _packet[_n - 2] == 0xFF && _packet[_n - 1] == 0xFD)
+            _packet.push_back(0xFD);
+    }
+    UINT16_T _length = _packet.size() - PKT_INSTRUCTION + 2;
+    _packet[PKT_LENGTH_L] = DXL_LOBYTE(_length);
+    _packet[PKT_LENGTH_H] = DXL_HIBYTE(_length);
+    UINT16_T _crc = UpdateCRC(0, _packet.data(), _packet.size());
+    _packet.push_back(DXL_LOBYTE(_crc));
+    _packet.push_back(DXL_HIBYTE(_crc));
+
+    if(Happens(corrupt_rate_))
+        _packet[PKT_ID + rand_r(&seed_) % (_packet.size() - PKT_ID)] ^= 0x01;
+
+    // the device waits its return delay, the adapter holds received bytes back for its latency timer
+    double _byte_time = GetByteTime();
+    double _start = time + device->GetReturnDelayTime() * 0.001;
+    for(size_t _i = 0; _i < _packet.size(); _i++)
+    {
+        RxByte _byte;
+        _byte.data = _packet[_i];
+        _byte.visible_time = _start + (_i + 1) * _byte_time + latency_timer_;
+        rx_buffer_.push_back(_byte);
+    }
+    return _start + _packet.size() * _byte_time;
+}
+
+void PortHandlerSim::SetPacketTimeout(UINT16_T packet_length)
+{
+    packet_start_time_  = GetCurrentTime();
+    packet_timeout_     = (tx_time_per_byte * (double)packet_length) + (latency_timer_ * 2.0) + 2.0;
+}
+
+void PortHandlerSim::SetPacketTimeout(double msec)
+{
+    packet_start_time_  = GetCurrentTime();
+    packet_timeout_     = msec;
+}
+
+void PortHandlerSim::SetBlockingRead(bool enable)
+{
+    blocking_read_ = enable;
+}
+
+bool PortHandlerSim::IsPacketTimeout()
+{
+    if(GetTimeSinceStart() > packet_timeout_)
+    {
+        packet_timeout_ = 0;
+        return true;
+    }
+    return false;
+}
+
+double PortHandlerSim::GetCurrentTime()
+{
+    struct timespec _tv;
+    clock_gettime(CLOCK_MONOTONIC, &_tv);
+    return ((double)_tv.tv_sec*1000.0 + (double)_tv.tv_nsec*0.001*0.001);
+}
+
+double PortHandlerSim::GetTimeSinceStart()
+{
+    double _time;
+
+    _time = GetCurrentTime() - packet_start_time_;
+    if(_time < 0.0)
+        packet_start_time_ = GetCurrentTime();
+
+    return _time;
+}
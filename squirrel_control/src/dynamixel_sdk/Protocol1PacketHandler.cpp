@@ -319,6 +319,11 @@ int Protocol1PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T
     return COMM_NOT_AVAILABLE;
 }
 
+int Protocol1PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T> &id_list, std::vector<UINT16_T> &model_list)
+{
+    return COMM_NOT_AVAILABLE;
+}
+
 int Protocol1PacketHandler::Action(PortHandler *port, UINT8_T id)
 {
     UINT8_T txpacket[6]         = {0};
@@ -14,8 +14,10 @@
 #include <stdlib.h>
 #include <dynamixel_sdk/Protocol2PacketHandler.h>
 
-#define TXPACKET_MAX_LEN    (4*1024)
-#define RXPACKET_MAX_LEN    (4*1024)
+// packets are built in place in port->tx_packet, the instructions refuse parameters that would not fit before
+// copying them
+#define TXPACKET_MAX_LEN    PACKET_BUFFER_LEN
+#define RXPACKET_MAX_LEN    PACKET_BUFFER_LEN
 
 ///////////////// for Protocol 2.0 Packet /////////////////
 #define PKT_HEADER0             0
@@ -137,115 +139,106 @@ void Protocol2PacketHandler::PrintRxPacketError(UINT8_T error)
     }
 }
 
+// CRC-16 (polynomial 0x8005, MSB first). CRC_TABLE[k][v] is the CRC of byte v followed by k zero bytes, so four
+// bytes are folded in with four independent lookups. The tables are computed by the compiler and live in .rodata.
+static constexpr UINT16_T CrcShift(UINT16_T crc, int bits)
+{
+    return bits == 0 ? crc : CrcShift((crc & 0x8000) ? (UINT16_T)((crc << 1) ^ 0x8005) : (UINT16_T)(crc << 1), bits - 1);
+}
+
+#define CRC_ENTRY(k, v)     CrcShift((UINT16_T)((v) << 8), 8 * ((k) + 1))
+#define CRC_ENTRIES_4(k, v) CRC_ENTRY(k, (v)), CRC_ENTRY(k, (v) + 1), CRC_ENTRY(k, (v) + 2), CRC_ENTRY(k, (v) + 3)
+#define CRC_ENTRIES_16(k, v) CRC_ENTRIES_4(k, (v)), CRC_ENTRIES_4(k, (v) + 4), CRC_ENTRIES_4(k, (v) + 8), CRC_ENTRIES_4(k, (v) + 12)
+#define CRC_ENTRIES_64(k, v) CRC_ENTRIES_16(k, (v)), CRC_ENTRIES_16(k, (v) + 16), CRC_ENTRIES_16(k, (v) + 32), CRC_ENTRIES_16(k, (v) + 48)
+#define CRC_TABLE_ROW(k)    { CRC_ENTRIES_64(k, 0), CRC_ENTRIES_64(k, 64), CRC_ENTRIES_64(k, 128), CRC_ENTRIES_64(k, 192) }
+
+static constexpr UINT16_T CRC_TABLE[4][256] = { CRC_TABLE_ROW(0), CRC_TABLE_ROW(1), CRC_TABLE_ROW(2), CRC_TABLE_ROW(3) };
+
+static_assert(CRC_TABLE[0][1] == 0x8005 && CRC_TABLE[0][255] == 0x0202, "CRC table does not match the Protocol 2.0 one");
+
 unsigned short Protocol2PacketHandler::UpdateCRC(UINT16_T crc_accum, UINT8_T *data_blk_ptr, UINT16_T data_blk_size)
 {
-    UINT16_T i, j;
-    UINT16_T crc_table[256] = {0x0000,
-    0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
-    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027,
-    0x0022, 0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D,
-    0x8077, 0x0072, 0x0050, 0x8055, 0x805F, 0x005A, 0x804B,
-    0x004E, 0x0044, 0x8041, 0x80C3, 0x00C6, 0x00CC, 0x80C9,
-    0x00D8, 0x80DD, 0x80D7, 0x00D2, 0x00F0, 0x80F5, 0x80FF,
-    0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1, 0x00A0, 0x80A5,
-    0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1, 0x8093,
-    0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082,
-    0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197,
-    0x0192, 0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE,
-    0x01A4, 0x81A1, 0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB,
-    0x01FE, 0x01F4, 0x81F1, 0x81D3, 0x01D6, 0x01DC, 0x81D9,
-    0x01C8, 0x81CD, 0x81C7, 0x01C2, 0x0140, 0x8145, 0x814F,
-    0x014A, 0x815B, 0x015E, 0x0154, 0x8151, 0x8173, 0x0176,
-    0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162, 0x8123,
-    0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132,
-    0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104,
-    0x8101, 0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D,
-    0x8317, 0x0312, 0x0330, 0x8335, 0x833F, 0x033A, 0x832B,
-    0x032E, 0x0324, 0x8321, 0x0360, 0x8365, 0x836F, 0x036A,
-    0x837B, 0x037E, 0x0374, 0x8371, 0x8353, 0x0356, 0x035C,
-    0x8359, 0x0348, 0x834D, 0x8347, 0x0342, 0x03C0, 0x83C5,
-    0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1, 0x83F3,
-    0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2,
-    0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7,
-    0x03B2, 0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E,
-    0x0384, 0x8381, 0x0280, 0x8285, 0x828F, 0x028A, 0x829B,
-    0x029E, 0x0294, 0x8291, 0x82B3, 0x02B6, 0x02BC, 0x82B9,
-    0x02A8, 0x82AD, 0x82A7, 0x02A2, 0x82E3, 0x02E6, 0x02EC,
-    0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2, 0x02D0, 0x82D5,
-    0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1, 0x8243,
-    0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252,
-    0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264,
-    0x8261, 0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E,
-    0x0234, 0x8231, 0x8213, 0x0216, 0x021C, 0x8219, 0x0208,
-    0x820D, 0x8207, 0x0202 };
-
-    for(j = 0; j < data_blk_size; j++)
+    UINT16_T j = 0;
+
+    // slice by 4: the register covers the first two bytes of each block
+    for(; j + 4 <= data_blk_size; j += 4, data_blk_ptr += 4)
     {
-        i = ((UINT16_T)(crc_accum >> 8) ^ *data_blk_ptr++) & 0xFF;
-        crc_accum = (crc_accum << 8) ^ crc_table[i];
+        crc_accum = CRC_TABLE[3][(UINT8_T)(crc_accum >> 8) ^ data_blk_ptr[0]] ^
+                    CRC_TABLE[2][(UINT8_T)crc_accum ^ data_blk_ptr[1]] ^
+                    CRC_TABLE[1][data_blk_ptr[2]] ^
+                    CRC_TABLE[0][data_blk_ptr[3]];
     }
 
+    for(; j < data_blk_size; j++)
+        crc_accum = (UINT16_T)(crc_accum << 8) ^ CRC_TABLE[0][((crc_accum >> 8) ^ *data_blk_ptr++) & 0xFF];
+
     return crc_accum;
 }
 
-void Protocol2PacketHandler::AddStuffing(UINT8_T *packet)
+// Stuffs in place, the packet buffer has to hold TXPACKET_MAX_LEN bytes. Returns false if the stuffed packet
+// would not fit.
+bool Protocol2PacketHandler::AddStuffing(UINT8_T *packet)
 {
-    int i = 0, index = 0;
-    int packet_length_in = DXL_MAKEWORD(packet[PKT_LENGTH_L], packet[PKT_LENGTH_H]);
-    int packet_length_out = packet_length_in;
-    UINT8_T temp[TXPACKET_MAX_LEN] = {0};
+    int _packet_length_in = DXL_MAKEWORD(packet[PKT_LENGTH_L], packet[PKT_LENGTH_H]);
+    int _end = PKT_INSTRUCTION + _packet_length_in - 2;     // except CRC
 
-    for(UINT8_T _s = PKT_HEADER0; _s <= PKT_LENGTH_H; _s++)
-        temp[_s] = packet[_s]; // FF FF FD XX ID LEN_L LEN_H
-    //memcpy(temp, packet, PKT_LENGTH_H+1);
-    index = PKT_INSTRUCTION;
-    for( i = 0; i < packet_length_in - 2; i++)  // except CRC
+    // count the FF FF FD sequences first, most packets have none and are left untouched
+    int _stuffing = 0;
+    for(int _i = PKT_INSTRUCTION; _i < _end; _i++)
     {
-        temp[index++] = packet[i+PKT_INSTRUCTION];
-        if(packet[i+PKT_INSTRUCTION] == 0xFD && packet[i+PKT_INSTRUCTION-1] == 0xFF && packet[i+PKT_INSTRUCTION-2] == 0xFF)
+        if(packet[_i] == 0xFD && packet[_i-1] == 0xFF && packet[_i-2] == 0xFF)
+            _stuffing++;
+    }
+    if(_stuffing == 0)
+        return true;
+    int _packet_length_out = _packet_length_in + _stuffing;
+    if(PKT_INSTRUCTION + _packet_length_out > TXPACKET_MAX_LEN)
+        return false;
+
+    // move the bytes up from the back, inserting an FD behind every FF FF FD; the bytes in front of the one
+    // being moved are not overwritten before they have been looked at
+    int _out = _end + _stuffing;
+    for(int _i = _end - 1; _stuffing > 0; _i--)
+    {
+        packet[--_out] = packet[_i];
+        if(packet[_i] == 0xFD && packet[_i-1] == 0xFF && packet[_i-2] == 0xFF)
         {   // FF FF FD
-            temp[index++] = 0xFD;
-            packet_length_out++;
+            packet[--_out] = 0xFD;
+            _stuffing--;
         }
     }
-    temp[index++] = packet[PKT_INSTRUCTION+packet_length_in-2];
-    temp[index++] = packet[PKT_INSTRUCTION+packet_length_in-1];
-
-
-    //////////////////////////
-    if(packet_length_in != packet_length_out)
-        packet = (UINT8_T *)realloc(packet, index * sizeof(UINT8_T));
 
-    ///////////////////////////
-
-    for(UINT8_T _s = 0; _s < index; _s++)
-        packet[_s] = temp[_s];
-    //memcpy(packet, temp, index);
-    packet[PKT_LENGTH_L] = DXL_LOBYTE(packet_length_out);
-    packet[PKT_LENGTH_H] = DXL_HIBYTE(packet_length_out);
+    packet[PKT_LENGTH_L] = DXL_LOBYTE(_packet_length_out);
+    packet[PKT_LENGTH_H] = DXL_HIBYTE(_packet_length_out);
+    return true;
 }
 
 void Protocol2PacketHandler::RemoveStuffing(UINT8_T *packet)
 {
-    int i = 0, index = 0;
-    int packet_length_in = DXL_MAKEWORD(packet[PKT_LENGTH_L], packet[PKT_LENGTH_H]);
-    int packet_length_out = packet_length_in;
+    int _packet_length_in = DXL_MAKEWORD(packet[PKT_LENGTH_L], packet[PKT_LENGTH_H]);
+    int _end = PKT_INSTRUCTION + _packet_length_in - 2;     // except CRC
+
+    // nothing is moved unless the packet is stuffed
+    int _i = PKT_INSTRUCTION;
+    while(_i < _end - 1 && !(packet[_i+1] == 0xFD && packet[_i] == 0xFD && packet[_i-1] == 0xFF && packet[_i-2] == 0xFF))
+        _i++;
+    if(_i >= _end - 1)
+        return;
 
-    index = PKT_INSTRUCTION;
-    for( i = 0; i < packet_length_in - 2; i++)  // except CRC
+    // the FD following every FF FF FD of the unstuffed data is dropped
+    int _index = _i + 1;
+    for(_i += 2; _i < _end; _i++)
     {
-        if(packet[i+PKT_INSTRUCTION] == 0xFD && packet[i+PKT_INSTRUCTION+1] == 0xFD && packet[i+PKT_INSTRUCTION-1] == 0xFF && packet[i+PKT_INSTRUCTION-2] == 0xFF)
-        {   // FF FF FD FD
-            packet_length_out--;
-            i++;
-        }
-        packet[index++] = packet[i+PKT_INSTRUCTION];
+        packet[_index++] = packet[_i];
+        if(_i + 1 < _end && packet[_i+1] == 0xFD && packet[_index-1] == 0xFD && packet[_index-2] == 0xFF && packet[_index-3] == 0xFF)
+            _i++;   // FF FF FD FD
     }
-    packet[index++] = packet[PKT_INSTRUCTION+packet_length_in-2];
-    packet[index++] = packet[PKT_INSTRUCTION+packet_length_in-1];
+    packet[_index++] = packet[_end];
+    packet[_index++] = packet[_end + 1];
 
-    packet[PKT_LENGTH_L] = DXL_LOBYTE(packet_length_out);
-    packet[PKT_LENGTH_H] = DXL_HIBYTE(packet_length_out);
+    int _packet_length_out = _index - PKT_INSTRUCTION;
+    packet[PKT_LENGTH_L] = DXL_LOBYTE(_packet_length_out);
+    packet[PKT_LENGTH_H] = DXL_HIBYTE(_packet_length_out);
 }
 
 int Protocol2PacketHandler::TxPacket(PortHandler *port, UINT8_T *txpacket)
@@ -258,7 +251,11 @@ int Protocol2PacketHandler::TxPacket(PortHandler *port, UINT8_T *txpacket)
     port->is_using = true;
 
     // byte stuffing for header
-    AddStuffing(txpacket);
+    if(!AddStuffing(txpacket))
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
 
     // check max packet length
     _total_packet_length = DXL_MAKEWORD(txpacket[PKT_LENGTH_L], txpacket[PKT_LENGTH_H]) + 7;
@@ -318,13 +315,11 @@ int Protocol2PacketHandler::RxPacket(PortHandler *port, UINT8_T *rxpacket)
             {
                 if(rxpacket[PKT_RESERVED] != 0x00 ||
                    rxpacket[PKT_ID] > 0xFC ||
-                   DXL_MAKEWORD(rxpacket[PKT_LENGTH_L], rxpacket[PKT_LENGTH_H]) > RXPACKET_MAX_LEN ||
+                   DXL_MAKEWORD(rxpacket[PKT_LENGTH_L], rxpacket[PKT_LENGTH_H]) + PKT_LENGTH_H + 1 > RXPACKET_MAX_LEN ||
                    rxpacket[PKT_INSTRUCTION] != 0x55)
                 {
                     // remove the first byte in the packet
-                    for(UINT8_T _s = 0; _s < _rx_length - 1; _s++)
-                        rxpacket[_s] = rxpacket[1 + _s];
-                    //memcpy(&rxpacket[0], &rxpacket[_idx], _rx_length - _idx);
+                    memmove(&rxpacket[0], &rxpacket[1], _rx_length - 1);
                     _rx_length -= 1;
                     continue;
                 }
@@ -362,9 +357,7 @@ int Protocol2PacketHandler::RxPacket(PortHandler *port, UINT8_T *rxpacket)
             else
             {
                 // remove unnecessary packets
-                for(UINT8_T _s = 0; _s < _rx_length - _idx; _s++)
-                    rxpacket[_s] = rxpacket[_idx + _s];
-                //memcpy(&rxpacket[0], &rxpacket[_idx], _rx_length - _idx);
+                memmove(&rxpacket[0], &rxpacket[_idx], _rx_length - _idx);
                 _rx_length -= _idx;
             }
         }
@@ -439,8 +432,8 @@ int Protocol2PacketHandler::Ping(PortHandler *port, UINT8_T id, UINT16_T *model_
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T txpacket[10]        = {0};
-    UINT8_T rxpacket[14]        = {0};
+    UINT8_T *txpacket           = port->tx_packet;
+    UINT8_T *rxpacket           = port->rx_packet;
 
     if(id >= BROADCAST_ID)
         return COMM_NOT_AVAILABLE;
@@ -458,17 +451,24 @@ int Protocol2PacketHandler::Ping(PortHandler *port, UINT8_T id, UINT16_T *model_
 }
 
 int Protocol2PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T> &id_list)
+{
+    std::vector<UINT16_T> _model_list;
+    return BroadcastPing(port, id_list, _model_list);
+}
+
+int Protocol2PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T> &id_list, std::vector<UINT16_T> &model_list)
 {
     const int STATUS_LENGTH     = 14;
     int _result                 = COMM_TX_FAIL;
 
     id_list.clear();
+    model_list.clear();
 
     UINT16_T _rx_length         = 0;
     UINT16_T _wait_length       = STATUS_LENGTH * MAX_ID;
 
-    UINT8_T txpacket[10]        = {0};
-    UINT8_T rxpacket[STATUS_LENGTH * MAX_ID] = {0};
+    UINT8_T *txpacket           = port->tx_packet;
+    UINT8_T *rxpacket           = port->rx_packet;
 
     txpacket[PKT_ID]            = BROADCAST_ID;
     txpacket[PKT_LENGTH_L]      = 3;
@@ -521,8 +521,9 @@ int Protocol2PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T
                 _result = COMM_SUCCESS;
 
                 id_list.push_back(rxpacket[PKT_ID]);
+                model_list.push_back(DXL_MAKEWORD(rxpacket[PKT_PARAMETER0+1], rxpacket[PKT_PARAMETER0+2]));
 
-                for(UINT8_T _s = 0; _s < _rx_length - STATUS_LENGTH; _s++)
+                for(UINT16_T _s = 0; _s < _rx_length - STATUS_LENGTH; _s++)
                     rxpacket[_s] = rxpacket[STATUS_LENGTH + _s];
                 _rx_length -= STATUS_LENGTH;
 
@@ -534,7 +535,7 @@ int Protocol2PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T
                 _result = COMM_RX_CORRUPT;
 
                 // remove header (0xFF 0xFF 0xFD)
-                for(UINT8_T _s = 0; _s < _rx_length - 3; _s++)
+                for(UINT16_T _s = 0; _s < _rx_length - 3; _s++)
                     rxpacket[_s] = rxpacket[3 + _s];
                 _rx_length -= 3;
             }
@@ -542,7 +543,7 @@ int Protocol2PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T
         else
         {
             // remove unnecessary packets
-            for(UINT8_T _s = 0; _s < _rx_length - _idx; _s++)
+            for(UINT16_T _s = 0; _s < _rx_length - _idx; _s++)
                 rxpacket[_s] = rxpacket[_idx + _s];
             _rx_length -= _idx;
         }
@@ -553,7 +554,7 @@ int Protocol2PacketHandler::BroadcastPing(PortHandler *port, std::vector<UINT8_T
 
 int Protocol2PacketHandler::Action(PortHandler *port, UINT8_T id)
 {
-    UINT8_T txpacket[10]        = {0};
+    UINT8_T *txpacket           = port->tx_packet;
 
     txpacket[PKT_ID]            = id;
     txpacket[PKT_LENGTH_L]      = 3;
@@ -565,8 +566,8 @@ int Protocol2PacketHandler::Action(PortHandler *port, UINT8_T id)
 
 int Protocol2PacketHandler::Reboot(PortHandler *port, UINT8_T id, UINT8_T *error)
 {
-    UINT8_T txpacket[10]        = {0};
-    UINT8_T rxpacket[11]        = {0};
+    UINT8_T *txpacket           = port->tx_packet;
+    UINT8_T *rxpacket           = port->rx_packet;
 
     txpacket[PKT_ID]            = id;
     txpacket[PKT_LENGTH_L]      = 3;
@@ -578,8 +579,8 @@ int Protocol2PacketHandler::Reboot(PortHandler *port, UINT8_T id, UINT8_T *error
 
 int Protocol2PacketHandler::FactoryReset(PortHandler *port, UINT8_T id, UINT8_T option, UINT8_T *error)
 {
-    UINT8_T txpacket[11]        = {0};
-    UINT8_T rxpacket[11]        = {0};
+    UINT8_T *txpacket           = port->tx_packet;
+    UINT8_T *rxpacket           = port->rx_packet;
 
     txpacket[PKT_ID]            = id;
     txpacket[PKT_LENGTH_L]      = 4;
@@ -594,7 +595,7 @@ int Protocol2PacketHandler::ReadTx(PortHandler *port, UINT8_T id, UINT16_T addre
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T txpacket[14]        = {0};
+    UINT8_T *txpacket           = port->tx_packet;
 
     if(id >= BROADCAST_ID)
         return COMM_NOT_AVAILABLE;
@@ -620,21 +621,16 @@ int Protocol2PacketHandler::ReadTx(PortHandler *port, UINT8_T id, UINT16_T addre
 int Protocol2PacketHandler::ReadRx(PortHandler *port, UINT16_T length, UINT8_T *data, UINT8_T *error)
 {
     int _result                 = COMM_TX_FAIL;
-    UINT8_T *rxpacket           = (UINT8_T *)malloc(RXPACKET_MAX_LEN);//(length + 11 + (length/3));  // (length/3): consider stuffing
-    //UINT8_T *rxpacket           = new UINT8_T[length + 11 + (length/3)];    // (length/3): consider stuffing
+    UINT8_T *rxpacket           = port->rx_packet;
 
     _result = RxPacket(port, rxpacket);
     if(_result == COMM_SUCCESS)
     {
         if(error != 0)
             *error = (UINT8_T)rxpacket[PKT_ERROR];
-        for(UINT8_T _s = 0; _s < length; _s++)
-            data[_s] = rxpacket[PKT_PARAMETER0 + 1 + _s];
-        //memcpy(data, &rxpacket[PKT_PARAMETER0+1], length);
+        memcpy(data, &rxpacket[PKT_PARAMETER0+1], length);
     }
 
-    free(rxpacket);
-    //delete[] rxpacket;
     return _result;
 }
 
@@ -642,8 +638,8 @@ int Protocol2PacketHandler::ReadTxRx(PortHandler *port, UINT8_T id, UINT16_T add
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T txpacket[14]        = {0};
-    UINT8_T *rxpacket           = (UINT8_T *)malloc(RXPACKET_MAX_LEN);//(length + 11 + (length/3));  // (length/3): consider stuffing
+    UINT8_T *txpacket           = port->tx_packet;
+    UINT8_T *rxpacket           = port->rx_packet;
 
     if(id >= BROADCAST_ID)
         return COMM_NOT_AVAILABLE;
@@ -662,13 +658,9 @@ int Protocol2PacketHandler::ReadTxRx(PortHandler *port, UINT8_T id, UINT16_T add
     {
         if(error != 0)
             *error = (UINT8_T)rxpacket[PKT_ERROR];
-        for(UINT8_T _s = 0; _s < length; _s++)
-            data[_s] = rxpacket[PKT_PARAMETER0 + 1 + _s];
-        //memcpy(data, &rxpacket[PKT_PARAMETER0+1], length);
+        memcpy(data, &rxpacket[PKT_PARAMETER0+1], length);
     }
 
-    free(rxpacket);
-    //delete[] rxpacket;
     return _result;
 }
 
@@ -740,8 +732,13 @@ int Protocol2PacketHandler::WriteTxOnly(PortHandler *port, UINT8_T id, UINT16_T
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(length+12);
-    //UINT8_T *txpacket           = new UINT8_T[length+12];
+    UINT8_T *txpacket           = port->tx_packet;
+
+    if(PKT_PARAMETER0+2 + length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
 
     txpacket[PKT_ID]            = id;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(length+5);
@@ -750,15 +747,11 @@ int Protocol2PacketHandler::WriteTxOnly(PortHandler *port, UINT8_T id, UINT16_T
     txpacket[PKT_PARAMETER0+0]  = (UINT8_T)DXL_LOBYTE(address);
     txpacket[PKT_PARAMETER0+1]  = (UINT8_T)DXL_HIBYTE(address);
 
-    for(UINT8_T _s = 0; _s < length; _s++)
-        txpacket[PKT_PARAMETER0+2+_s] = data[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
+    memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
 
     _result = TxPacket(port, txpacket);
     port->is_using = false;
 
-    free(txpacket);
-    //delete[] txpacket;
     return _result;
 }
 
@@ -766,9 +759,14 @@ int Protocol2PacketHandler::WriteTxRx(PortHandler *port, UINT8_T id, UINT16_T ad
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(length + 12);
-    //UINT8_T *txpacket           = new UINT8_T[length+12];
-    UINT8_T rxpacket[11]        = {0};
+    UINT8_T *txpacket           = port->tx_packet;
+    UINT8_T *rxpacket           = port->rx_packet;
+
+    if(PKT_PARAMETER0+2 + length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
 
     txpacket[PKT_ID]            = id;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(length+5);
@@ -777,14 +775,10 @@ int Protocol2PacketHandler::WriteTxRx(PortHandler *port, UINT8_T id, UINT16_T ad
     txpacket[PKT_PARAMETER0+0]  = (UINT8_T)DXL_LOBYTE(address);
     txpacket[PKT_PARAMETER0+1]  = (UINT8_T)DXL_HIBYTE(address);
 
-    for(UINT8_T _s = 0; _s < length; _s++)
-        txpacket[PKT_PARAMETER0+2+_s] = data[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
+    memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
 
     _result = TxRxPacket(port, txpacket, rxpacket, error);
 
-    free(txpacket);
-    //delete[] txpacket;
     return _result;
 }
 
@@ -825,8 +819,13 @@ int Protocol2PacketHandler::RegWriteTxOnly(PortHandler *port, UINT8_T id, UINT16
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(length + 12);
-    //UINT8_T *txpacket           = new UINT8_T[length+12];
+    UINT8_T *txpacket           = port->tx_packet;
+
+    if(PKT_PARAMETER0+2 + length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
 
     txpacket[PKT_ID]            = id;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(length+5);
@@ -835,15 +834,11 @@ int Protocol2PacketHandler::RegWriteTxOnly(PortHandler *port, UINT8_T id, UINT16
     txpacket[PKT_PARAMETER0+0]  = (UINT8_T)DXL_LOBYTE(address);
     txpacket[PKT_PARAMETER0+1]  = (UINT8_T)DXL_HIBYTE(address);
 
-    for(UINT8_T _s = 0; _s < length; _s++)
-        txpacket[PKT_PARAMETER0+2+_s] = data[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
+    memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
 
     _result = TxPacket(port, txpacket);
     port->is_using = false;
 
-    free(txpacket);
-    //delete[] txpacket;
     return _result;
 }
 
@@ -851,9 +846,14 @@ int Protocol2PacketHandler::RegWriteTxRx(PortHandler *port, UINT8_T id, UINT16_T
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(length + 12);
-    //UINT8_T *txpacket           = new UINT8_T[length+12];
-    UINT8_T rxpacket[11]        = {0};
+    UINT8_T *txpacket           = port->tx_packet;
+    UINT8_T *rxpacket           = port->rx_packet;
+
+    if(PKT_PARAMETER0+2 + length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
 
     txpacket[PKT_ID]            = id;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(length+5);
@@ -862,14 +862,10 @@ int Protocol2PacketHandler::RegWriteTxRx(PortHandler *port, UINT8_T id, UINT16_T
     txpacket[PKT_PARAMETER0+0]  = (UINT8_T)DXL_LOBYTE(address);
     txpacket[PKT_PARAMETER0+1]  = (UINT8_T)DXL_HIBYTE(address);
 
-    for(UINT8_T _s = 0; _s < length; _s++)
-        txpacket[PKT_PARAMETER0+2+_s] = data[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
+    memcpy(&txpacket[PKT_PARAMETER0+2], data, length);
 
     _result = TxRxPacket(port, txpacket, rxpacket, error);
 
-    free(txpacket);
-    //delete[] txpacket;
     return _result;
 }
 
@@ -877,9 +873,15 @@ int Protocol2PacketHandler::SyncReadTx(PortHandler *port, UINT16_T start_address
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(param_length + 14);
+    UINT8_T *txpacket           = port->tx_packet;
             // 14: HEADER0 HEADER1 HEADER2 RESERVED ID LEN_L LEN_H INST START_ADDR_L START_ADDR_H DATA_LEN_L DATA_LEN_H CRC16_L CRC16_H
 
+    if(PKT_PARAMETER0+4 + param_length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
+
     txpacket[PKT_ID]            = BROADCAST_ID;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(param_length + 7); // 7: INST START_ADDR_L START_ADDR_H DATA_LEN_L DATA_LEN_H CRC16_L CRC16_H
     txpacket[PKT_LENGTH_H]      = DXL_HIBYTE(param_length + 7); // 7: INST START_ADDR_L START_ADDR_H DATA_LEN_L DATA_LEN_H CRC16_L CRC16_H
@@ -889,15 +891,12 @@ int Protocol2PacketHandler::SyncReadTx(PortHandler *port, UINT16_T start_address
     txpacket[PKT_PARAMETER0+2]  = DXL_LOBYTE(data_length);
     txpacket[PKT_PARAMETER0+3]  = DXL_HIBYTE(data_length);
 
-    for(UINT8_T _s = 0; _s < param_length; _s++)
-        txpacket[PKT_PARAMETER0+4+_s] = param[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0+4], param, param_length);
+    memcpy(&txpacket[PKT_PARAMETER0+4], param, param_length);
 
     _result = TxPacket(port, txpacket);
     if(_result == COMM_SUCCESS)
         port->SetPacketTimeout((UINT16_T)((11 + data_length) * param_length));
 
-    free(txpacket);
     return _result;
 }
 
@@ -905,10 +904,15 @@ int Protocol2PacketHandler::SyncWriteTxOnly(PortHandler *port, UINT16_T start_ad
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(param_length + 14);
-    //UINT8_T *txpacket           = new UINT8_T[param_length + 14];
+    UINT8_T *txpacket           = port->tx_packet;
             // 14: HEADER0 HEADER1 HEADER2 RESERVED ID LEN_L LEN_H INST START_ADDR_L START_ADDR_H DATA_LEN_L DATA_LEN_H CRC16_L CRC16_H
 
+    if(PKT_PARAMETER0+4 + param_length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
+
     txpacket[PKT_ID]            = BROADCAST_ID;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(param_length + 7); // 7: INST START_ADDR_L START_ADDR_H DATA_LEN_L DATA_LEN_H CRC16_L CRC16_H
     txpacket[PKT_LENGTH_H]      = DXL_HIBYTE(param_length + 7); // 7: INST START_ADDR_L START_ADDR_H DATA_LEN_L DATA_LEN_H CRC16_L CRC16_H
@@ -918,14 +922,10 @@ int Protocol2PacketHandler::SyncWriteTxOnly(PortHandler *port, UINT16_T start_ad
     txpacket[PKT_PARAMETER0+2]  = DXL_LOBYTE(data_length);
     txpacket[PKT_PARAMETER0+3]  = DXL_HIBYTE(data_length);
 
-    for(UINT8_T _s = 0; _s < param_length; _s++)
-        txpacket[PKT_PARAMETER0+4+_s] = param[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0+4], param, param_length);
+    memcpy(&txpacket[PKT_PARAMETER0+4], param, param_length);
 
     _result = TxRxPacket(port, txpacket, 0, 0);
 
-    free(txpacket);
-    //delete[] txpacket;
     return _result;
 }
 
@@ -933,18 +933,21 @@ int Protocol2PacketHandler::BulkReadTx(PortHandler *port, UINT8_T *param, UINT16
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(param_length + 10);
-    //UINT8_T *txpacket           = new UINT8_T[param_length + 10];
+    UINT8_T *txpacket           = port->tx_packet;
             // 10: HEADER0 HEADER1 HEADER2 RESERVED ID LEN_L LEN_H INST CRC16_L CRC16_H
 
+    if(PKT_PARAMETER0 + param_length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
+
     txpacket[PKT_ID]            = BROADCAST_ID;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(param_length + 3); // 3: INST CRC16_L CRC16_H
     txpacket[PKT_LENGTH_H]      = DXL_HIBYTE(param_length + 3); // 3: INST CRC16_L CRC16_H
     txpacket[PKT_INSTRUCTION]   = INST_BULK_READ;
 
-    for(UINT8_T _s = 0; _s < param_length; _s++)
-        txpacket[PKT_PARAMETER0+_s] = param[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0], param, param_length);
+    memcpy(&txpacket[PKT_PARAMETER0], param, param_length);
 
     _result = TxPacket(port, txpacket);
     if(_result == COMM_SUCCESS)
@@ -955,8 +958,6 @@ int Protocol2PacketHandler::BulkReadTx(PortHandler *port, UINT8_T *param, UINT16
         port->SetPacketTimeout((UINT16_T)_wait_length);
     }
 
-    free(txpacket);
-    //delete[] txpacket;
     return _result;
 }
 
@@ -964,22 +965,23 @@ int Protocol2PacketHandler::BulkWriteTxOnly(PortHandler *port, UINT8_T *param, U
 {
     int _result                 = COMM_TX_FAIL;
 
-    UINT8_T *txpacket           = (UINT8_T *)malloc(param_length + 10);
-    //UINT8_T *txpacket           = new UINT8_T[param_length + 10];
+    UINT8_T *txpacket           = port->tx_packet;
             // 10: HEADER0 HEADER1 HEADER2 RESERVED ID LEN_L LEN_H INST CRC16_L CRC16_H
 
+    if(PKT_PARAMETER0 + param_length + 2 > TXPACKET_MAX_LEN)     // 2: CRC16
+    {
+        port->is_using = false;
+        return COMM_TX_ERROR;
+    }
+
     txpacket[PKT_ID]            = BROADCAST_ID;
     txpacket[PKT_LENGTH_L]      = DXL_LOBYTE(param_length + 3); // 3: INST CRC16_L CRC16_H
     txpacket[PKT_LENGTH_H]      = DXL_HIBYTE(param_length + 3); // 3: INST CRC16_L CRC16_H
     txpacket[PKT_INSTRUCTION]   = INST_BULK_WRITE;
 
-    for(UINT8_T _s = 0; _s < param_length; _s++)
-        txpacket[PKT_PARAMETER0+_s] = param[_s];
-    //memcpy(&txpacket[PKT_PARAMETER0], param, param_length);
+    memcpy(&txpacket[PKT_PARAMETER0], param, param_length);
 
     _result = TxRxPacket(port, txpacket, 0, 0);
 
-    free(txpacket);
-    //delete[] txpacket;
     return _result;
 }
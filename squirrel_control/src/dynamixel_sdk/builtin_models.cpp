@@ -0,0 +1,258 @@
+/* Models of the SQUIRREL arm and neck compiled into the driver, see DynamixelTool::registerBuiltinModels() */
+
+#include "dynamixel_sdk/dynamixel_tool.h"
+
+using namespace dynamixel_tool;
+
+namespace {
+
+    // Verbatim copies of the .device files in models/, for the arm motors and the neck servos of
+    // config/controllers.yaml. Update them together with the files.
+
+    // models/PR/PRO_M54_60_S250_R.device
+    const char PRO_M54_60_S250_R[] = R"device([device info]
+model_number = 46352
+model_name  = PRO_M54_60_S250_R
+
+[type info]
+velocity_to_value_ratio 	= 2400.7
+
+value_of_0_radian_position      = 0
+value_of_min_radian_position    = -125700
+value_of_max_radian_position    =  125700
+min_radian                      = -3.14159265
+max_radian                      =  3.14159265
+
+[baud rate]
+# baud rate | value
+9600        | 0
+57600       | 1
+115200      | 2
+1000000     | 3
+2000000     | 4
+3000000     | 5
+4000000     | 6
+4500000     | 7
+10500000    | 8
+
+[control table]
+# addr | item name                | length | access | memory
+   0   | model_number             | 4      | R      | EEPROM
+   6   | version_of_firmware      | 1      | R      | EEPROM
+   7   | id                       | 1      | RW     | EEPROM
+   8   | baud_rate                | 1      | RW     | EEPROM
+   9   | return_delay_time        | 1      | RW     | EEPROM
+   11  | operating_mode           | 1      | RW     | EEPROM
+   13  | homing_offset            | 4      | RW     | EEPROM
+   17  | moving_threshold         | 4      | RW     | EEPROM
+   21  | max_temperature_limit    | 1      | RW     | EEPROM
+   22  | max_voltage_limit        | 2      | RW     | EEPROM
+   24  | min_voltage_limit        | 2      | RW     | EEPROM
+   26  | acceleration_limit       | 4      | RW     | EEPROM
+   30  | torque_limit             | 2      | RW     | EEPROM
+   32  | velocity_limit           | 4      | RW     | EEPROM
+   36  | max_position_limit       | 4      | RW     | EEPROM
+   40  | min_position_limit       | 4      | RW     | EEPROM
+   44  | external_port_mod_1      | 1      | RW     | EEPROM
+   45  | external_port_mod_2      | 1      | RW     | EEPROM
+   46  | external_port_mod_3      | 1      | RW     | EEPROM
+   47  | external_port_mod_4      | 1      | RW     | EEPROM
+   48  | shutdown                 | 1      | RW     | EEPROM
+   49  | indirect_address_1       | 2      | RW     | EEPROM
+   562 | torque_enable            | 1      | RW     | RAM
+   563 | led_red                  | 1      | RW     | RAM
+   564 | led_green                | 1      | RW     | RAM
+   565 | led_blue                 | 1      | RW     | RAM
+   586 | velocity_i_gain          | 2      | RW     | RAM
+   588 | velocity_p_gain          | 2      | RW     | RAM
+   594 | position_p_gain          | 2      | RW     | RAM
+   596 | goal_position            | 4      | RW     | RAM
+   600 | goal_velocity            | 4      | RW     | RAM
+   604 | goal_torque              | 2      | RW     | RAM
+   606 | goal_acceleration        | 4      | RW     | RAM
+   610 | moving                   | 1      | R      | RAM
+   611 | present_position         | 4      | R      | RAM
+   615 | present_velocity         | 4      | R      | RAM
+   621 | present_current          | 2      | R      | RAM
+   623 | present_voltage          | 2      | R      | RAM
+   625 | present_temperature      | 1      | R      | RAM
+   626 | external_port_data_1     | 2      | RW     | RAM
+   628 | external_port_data_2     | 2      | RW     | RAM
+   630 | external_port_data_3     | 2      | RW     | RAM
+   632 | external_port_data_4     | 2      | RW     | RAM
+   634 | indirect_data_1          | 1      | RW     | RAM
+   890 | registered_instruction   | 1      | R      | RAM
+   891 | status_return_level      | 1      | RW     | RAM
+   892 | hardware_error_status    | 2      | R      | RAM
+)device";
+
+    // models/PR/PRO_L54_50_S500_R.device
+    const char PRO_L54_50_S500_R[] = R"device([device info]
+model_number = 38152
+model_name  = PRO_L54_50_S500_R
+
+[type info]
+velocity_to_value_ratio 	= 2792.6
+
+value_of_0_radian_position      = 0
+value_of_min_radian_position    = -180684
+value_of_max_radian_position    =  180684
+min_radian                      = -3.14159265
+max_radian                      =  3.14159265
+
+[baud rate]
+# baud rate | value
+9600        | 0
+57600       | 1
+115200      | 2
+1000000     | 3
+2000000     | 4
+3000000     | 5
+4000000     | 6
+4500000     | 7
+10500000    | 8
+
+[control table]
+# addr | item name                | length | access | memory
+   0   | model_number             | 4      | R      | EEPROM
+   6   | version_of_firmware      | 1      | R      | EEPROM
+   7   | id                       | 1      | RW     | EEPROM
+   8   | baud_rate                | 1      | RW     | EEPROM
+   9   | return_delay_time        | 1      | RW     | EEPROM
+   11  | operating_mode           | 1      | RW     | EEPROM
+   13  | homing_offset            | 4      | RW     | EEPROM
+   17  | moving_threshold         | 4      | RW     | EEPROM
+   21  | max_temperature_limit    | 1      | RW     | EEPROM
+   22  | max_voltage_limit        | 2      | RW     | EEPROM
+   24  | min_voltage_limit        | 2      | RW     | EEPROM
+   26  | acceleration_limit       | 4      | RW     | EEPROM
+   30  | torque_limit             | 2      | RW     | EEPROM
+   32  | velocity_limit           | 4      | RW     | EEPROM
+   36  | max_position_limit       | 4      | RW     | EEPROM
+   40  | min_position_limit       | 4      | RW     | EEPROM
+   44  | external_port_mod_1      | 1      | RW     | EEPROM
+   45  | external_port_mod_2      | 1      | RW     | EEPROM
+   46  | external_port_mod_3      | 1      | RW     | EEPROM
+   47  | external_port_mod_4      | 1      | RW     | EEPROM
+   48  | shutdown                 | 1      | RW     | EEPROM
+   49  | indirect_address_1       | 2      | RW     | EEPROM
+   562 | torque_enable            | 1      | RW     | RAM
+   563 | led_red                  | 1      | RW     | RAM
+   564 | led_green                | 1      | RW     | RAM
+   565 | led_blue                 | 1      | RW     | RAM
+   586 | velocity_i_gain          | 2      | RW     | RAM
+   588 | velocity_p_gain          | 2      | RW     | RAM
+   594 | position_p_gain          | 2      | RW     | RAM
+   596 | goal_position            | 4      | RW     | RAM
+   600 | goal_velocity            | 4      | RW     | RAM
+   604 | goal_torque              | 2      | RW     | RAM
+   606 | goal_acceleration        | 4      | RW     | RAM
+   610 | moving                   | 1      | R      | RAM
+   611 | present_position         | 4      | R      | RAM
+   615 | present_velocity         | 4      | R      | RAM
+   621 | present_current          | 2      | R      | RAM
+   623 | present_voltage          | 2      | R      | RAM
+   625 | present_temperature      | 1      | R      | RAM
+   626 | external_port_data_1     | 2      | RW     | RAM
+   628 | external_port_data_2     | 2      | RW     | RAM
+   630 | external_port_data_3     | 2      | RW     | RAM
+   632 | external_port_data_4     | 2      | RW     | RAM
+   634 | indirect_data_1          | 1      | RW     | RAM
+   890 | registered_instruction   | 1      | R      | RAM
+   891 | status_return_level      | 1      | RW     | RAM
+   892 | hardware_error_status    | 2      | R      | RAM
+)device";
+
+    // models/XM/XM430_W350.device
+    const char XM430_W350[] = R"device([device info]
+model_number = 1020
+model_name  = XM430_W350
+
+[type info]
+torque_to_current_value_ratio   = 149.795386991
+velocity_to_value_ratio 	= 41.71
+
+value_of_0_radian_position      = 2048
+value_of_min_radian_position    = 0
+value_of_max_radian_position    = 4095
+min_radian                      = -3.14159265
+max_radian                      =  3.14159265
+
+[baud rate]
+# baud rate | value
+9600        | 0
+57600       | 1
+115200      | 2
+1000000     | 3
+2000000     | 4
+3000000     | 5
+4000000     | 6
+4500000     | 7
+
+[control table]
+# addr | item name                | length | access | memory
+   0   | model_number             | 2      | R      | EEPROM
+   6   | version_of_firmware      | 1      | R      | EEPROM
+   7   | id                       | 1      | RW     | EEPROM
+   8   | baud_rate                | 1      | RW     | EEPROM
+   9   | return_delay_time        | 1      | RW     | EEPROM
+   10  | drive_mode               | 1      | RW     | EEPROM
+   11  | operating_mode           | 1      | RW     | EEPROM
+   13  | protocol_version         | 1      | RW     | EEPROM
+   20  | homing_offset            | 4      | RW     | EEPROM
+   24  | moving_threshold         | 4      | RW     | EEPROM
+   31  | max_temperature_limit    | 1      | RW     | EEPROM
+   32  | max_voltage_limit        | 2      | RW     | EEPROM
+   34  | min_voltage_limit        | 2      | RW     | EEPROM
+   36  | pwm_limit                | 2      | RW     | EEPROM
+   38  | current_limit            | 2      | RW     | EEPROM
+   40  | acceleration_limit       | 4      | RW     | EEPROM
+   44  | velocity_limit           | 4      | RW     | EEPROM
+   48  | max_position_limit       | 4      | RW     | EEPROM
+   52  | min_position_limit       | 4      | RW     | EEPROM
+   63  | shutdown                 | 1      | RW     | EEPROM
+   64  | torque_enable            | 1      | RW     | RAM
+   65  | led                      | 1      | RW     | RAM
+   68  | status_return_level      | 1      | RW     | RAM
+   69  | registered_instruction   | 1      | R      | RAM
+   70  | hardware_error_status    | 1      | R      | RAM
+   76  | velocity_i_gain          | 2      | RW     | RAM
+   78  | velocity_p_gain          | 2      | RW     | RAM
+   80  | position_d_gain          | 2      | RW     | RAM
+   82  | position_i_gain          | 2      | RW     | RAM
+   84  | position_p_gain          | 2      | RW     | RAM
+   88  | feedforward_2nd_gain     | 2      | RW     | RAM
+   90  | feedforward_1st_gain     | 2      | RW     | RAM
+   100 | goal_pwm                 | 2      | RW     | RAM
+   102 | goal_current             | 2      | RW     | RAM
+   104 | goal_velocity            | 4      | RW     | RAM
+   108 | profile_acceleration     | 4      | RW     | RAM
+   112 | profile_velocity         | 4      | RW     | RAM
+   116 | goal_position            | 4      | RW     | RAM
+   120 | realtime_tick            | 2      | R      | RAM
+   122 | moving                   | 1      | R      | RAM
+   123 | moving_status            | 1      | R      | RAM
+   124 | present_pwm              | 2      | R      | RAM
+   126 | present_current          | 2      | R      | RAM
+   128 | present_velocity         | 4      | R      | RAM
+   132 | present_position         | 4      | R      | RAM
+   136 | velocity_trajectory      | 4      | R      | RAM
+   140 | position_trajectory      | 4      | R      | RAM
+   144 | present_input_voltage    | 2      | R      | RAM
+   146 | present_temperature      | 1      | R      | RAM
+   168 | indirect_address_1       | 2      | RW     | RAM
+   224 | indirect_data_1          | 1      | RW     | RAM
+   578 | indirect_address_29      | 2      | RW     | RAM
+   634 | indirect_data_29         | 1      | RW     | RAM
+)device";
+
+}
+
+void DynamixelTool::registerBuiltinModels() {
+    static std::once_flag registered;
+    std::call_once(registered, [] {
+        registerModel(46352, "PRO_M54_60_S250_R", PRO_M54_60_S250_R);
+        registerModel(38152, "PRO_L54_50_S500_R", PRO_L54_50_S500_R);
+        registerModel(1020, "XM430_W350", XM430_W350);
+    });
+}
@@ -32,9 +32,16 @@
 
 	#include "dynamixel_sdk/dynamixel_tool.h"
 	#include "error/throwControlError.h"
+	#include <sstream>
 
 	using namespace dynamixel_tool;
 
+	    // Process wide model registry, see DynamixelTool::registerModel()
+	    static std::mutex registry_lock;
+	    static std::map<uint16_t, std::string> model_names;
+	    static bool model_names_loaded = false;
+	    static std::map<std::string, ModelInfo> models;
+
 	    static inline std::string &ltrim(std::string &s) {
 	      s.erase(s.begin(), std::find_if(s.begin(), s.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
 	      return s;
@@ -72,6 +79,7 @@
 	      id_ = id;
 	      protocol_version_ = protocol_version;
 
+	      registerBuiltinModels();
 	      getModelName(model_number);
 	      getModelItem();
 	    }
@@ -87,6 +95,7 @@
 	      model_name_ = model_name;
 	      protocol_version_ = protocol_version;
 
+	      registerBuiltinModels();
 	      getModelItem();
 	    }
 
@@ -96,126 +105,218 @@
 	      //dynamixel_name_path_ = "../../dynamixel/models/model_info.list";
 	      dynamixel_name_path_ = ros::package::getPath("squirrel_control") + "/models/model_info.list";
 
-      std::ifstream file(dynamixel_name_path_.c_str());
-      if (file.is_open()) {
-        std::string input_str;
+      std::lock_guard<std::mutex> lock(registry_lock);
+      loadModelNames(dynamixel_name_path_);
 
-        while (!file.eof()) {
-          std::getline(file, input_str);
+      std::map<uint16_t, std::string>::iterator it = model_names.find(model_number);
+      throw_control_error(it == model_names.end(), "Unknown model number " << model_number << " in " << dynamixel_name_path_);
+      model_number_ = model_number;
+      model_name_ = it->second;
+      return true;
+    }
 
-          // remove comment ( # )
-          std::size_t pos = input_str.find("#");
-          if (pos != std::string::npos) {
-            input_str = input_str.substr(0, pos);
-          }
+    void DynamixelTool::loadModelNames(const std::string &path) {
+      if (model_names_loaded)
+        return;
 
-          std::vector <std::string> tokens = split(input_str, '|');
-          if (tokens.size() != 2)
-            continue;
+      std::ifstream file(path.c_str());
+      throw_control_error(!file.is_open() && model_names.empty(), "Unable to open model list: " << path);
 
-          if (model_number == std::atoi(tokens[0].c_str())) {
-            model_number_ = model_number;
-            model_name_ = tokens[1];
-          }
+      std::string input_str;
+      while (std::getline(file, input_str)) {
+        // remove comment ( # )
+        std::size_t pos = input_str.find("#");
+        if (pos != std::string::npos) {
+          input_str = input_str.substr(0, pos);
         }
-        file.close();
-      } else {
-	      std::string msg = "Unable to open .device file: " + item_path_;
-	      throw_control_error(true, msg);
 
+        std::vector <std::string> tokens = split(input_str, '|');
+        if (tokens.size() != 2)
+          continue;
+
+        // compiled-in models take precedence
+        model_names.insert(std::make_pair((uint16_t) std::atoi(tokens[0].c_str()), tokens[1]));
       }
+      model_names_loaded = true;
     }
 
     bool DynamixelTool::getModelPath() {
       std::string dynamixel_series = "";
       dynamixel_series = model_name_.substr(0, 2);
 
+      // the models shipped with this package, the system wide installation is only a fallback
+      item_path_ = ros::package::getPath("squirrel_control") + "/models/" + dynamixel_series + "/" + model_name_ + ".device";
+      if (access(item_path_.c_str(), R_OK) == 0)
+        return true;
+
       //item_path_ = "../../dynamixel";
       item_path_ = "/usr/local/dynamixel";
 
       item_path_ = item_path_ + "/models" + "/" + dynamixel_series + "/" + model_name_ + ".device";
+      return access(item_path_.c_str(), R_OK) == 0;
     }
 
     bool DynamixelTool::getModelItem() {
-      getModelPath();
+      const ModelInfo *model = NULL;
+      {
+        std::lock_guard<std::mutex> lock(registry_lock);
+        std::map<std::string, ModelInfo>::iterator it = models.find(model_name_);
+        if (it == models.end()) {
+          getModelPath();
+          std::ifstream file(item_path_.c_str());
+          throw_control_error(!file.is_open(), "Unable to open .device file: " << item_path_);
+
+          ModelInfo info = ModelInfo();
+          info.model_name = model_name_;
+          parseModel(file, info);
+          it = models.insert(std::make_pair(model_name_, info)).first;
+        }
+        model = &it->second;
+      }
+
+      // tools created by model name learn their number from the .device file
+      if (model_number_ == 0)
+        model_number_ = model->model_number;
+      velocity_to_value_ratio_ = model->velocity_to_value_ratio;
+      torque_to_current_value_ratio_ = model->torque_to_current_value_ratio;
+      value_of_0_radian_position_ = model->value_of_0_radian_position;
+      value_of_min_radian_position_ = model->value_of_min_radian_position;
+      value_of_max_radian_position_ = model->value_of_max_radian_position;
+      min_radian_ = model->min_radian;
+      max_radian_ = model->max_radian;
+      baud_rate_table_ = model->baud_rate_table;
+
+      // registry entries are never modified or removed once inserted, the tools share their items
+      ctrl_table_.clear();
+      for (std::map<std::string, ControlTableItem>::const_iterator it = model->ctrl_table.begin(); it != model->ctrl_table.end(); ++it)
+        ctrl_table_[it->first] = const_cast<ControlTableItem *>(&it->second);
+
+      resolveItems();
+      return true;
+    }
 
-      std::ifstream file(item_path_.c_str());
-      if (file.is_open()) {
-        std::string session = "";
-        std::string input_str;
+    void DynamixelTool::registerModel(uint16_t model_number, const std::string &model_name, const std::string &device) {
+      std::istringstream stream(device);
+      ModelInfo info = ModelInfo();
+      info.model_name = model_name;
+      parseModel(stream, info);
 
-        while (!file.eof()) {
-          std::getline(file, input_str);
+      std::lock_guard<std::mutex> lock(registry_lock);
+      model_names[model_number] = model_name;
+      // tools created before keep pointing at an existing entry, so it is not replaced
+      models.insert(std::make_pair(model_name, info));
+    }
 
-          // remove comment ( # )
-          std::size_t pos = input_str.find("#");
-          if (pos != std::string::npos) {
-            input_str = input_str.substr(0, pos);
-          }
+    bool DynamixelTool::parseModel(std::istream &stream, ModelInfo &model) {
+      std::string session = "";
+      std::string input_str;
 
-          // trim
-          input_str = trim(input_str);
-          if (input_str == "")
+      while (std::getline(stream, input_str)) {
+        // remove comment ( # )
+        std::size_t pos = input_str.find("#");
+        if (pos != std::string::npos) {
+          input_str = input_str.substr(0, pos);
+        }
+
+        // trim
+        input_str = trim(input_str);
+        if (input_str == "")
+          continue;
+
+        // find session;
+        if (!input_str.compare(0, 1, "[") && !input_str.compare(input_str.size() - 1, 1, "]")) {
+          input_str = input_str.substr(1, input_str.size() - 2);
+          std::transform(input_str.begin(), input_str.end(), input_str.begin(), ::tolower);
+          session = trim(input_str);
+          continue;
+        }
+
+        if (session == "device info") {
+          std::vector <std::string> tokens = split(input_str, '=');
+          if (tokens.size() == 2 && tokens[0] == "model_number")
+            model.model_number = (uint16_t) std::atoi(tokens[1].c_str());
+        } else if (session == "type info") {
+          std::vector <std::string> tokens = split(input_str, '=');
+          if (tokens.size() != 2)
             continue;
 
-          // find session;
-          if (!input_str.compare(0, 1, "[") && !input_str.compare(input_str.size() - 1, 1, "]")) {
-            input_str = input_str.substr(1, input_str.size() - 2);
-            std::transform(input_str.begin(), input_str.end(), input_str.begin(), ::tolower);
-            session = trim(input_str);
+          if (tokens[0] == "torque_to_current_value_ratio")
+            model.torque_to_current_value_ratio = std::atof(tokens[1].c_str());
+          else if (tokens[0] == "velocity_to_value_ratio")
+            model.velocity_to_value_ratio = std::atof(tokens[1].c_str());
+          else if (tokens[0] == "value_of_0_radian_position")
+            model.value_of_0_radian_position = std::atoi(tokens[1].c_str());
+          else if (tokens[0] == "value_of_min_radian_position")
+            model.value_of_min_radian_position = std::atoi(tokens[1].c_str());
+          else if (tokens[0] == "value_of_max_radian_position")
+            model.value_of_max_radian_position = std::atoi(tokens[1].c_str());
+          else if (tokens[0] == "min_radian")
+            model.min_radian = std::atof(tokens[1].c_str());
+          else if (tokens[0] == "max_radian")
+            model.max_radian = std::atof(tokens[1].c_str());
+        } else if (session == "baud rate") {
+          std::vector <std::string> tokens = split(input_str, '|');
+          if (tokens.size() != 2)
+            continue;
+
+          model.baud_rate_table[std::atoi(tokens[0].c_str())] = std::atoi(tokens[1].c_str());
+        } else if (session == "control table") {
+          std::vector <std::string> tokens = split(input_str, '|');
+          if (tokens.size() != 5)
             continue;
-          }
-
-          if (session == "type info") {
-            std::vector <std::string> tokens = split(input_str, '=');
-            if (tokens.size() != 2)
-              continue;
-
-            if (tokens[0] == "torque_to_current_value_ratio")
-              torque_to_current_value_ratio_ = std::atof(tokens[1].c_str());
-            else if (tokens[0] == "velocity_to_value_ratio")
-              velocity_to_value_ratio_ = std::atof(tokens[1].c_str());
-            else if (tokens[0] == "value_of_0_radian_position")
-              value_of_0_radian_position_ = std::atoi(tokens[1].c_str());
-            else if (tokens[0] == "value_of_min_radian_position")
-              value_of_min_radian_position_ = std::atoi(tokens[1].c_str());
-            else if (tokens[0] == "value_of_max_radian_position")
-              value_of_max_radian_position_ = std::atoi(tokens[1].c_str());
-            else if (tokens[0] == "min_radian")
-              min_radian_ = std::atof(tokens[1].c_str());
-            else if (tokens[0] == "max_radian")
-              max_radian_ = std::atof(tokens[1].c_str());
-          } else if (session == "baud rate") {
-            std::vector <std::string> tokens = split(input_str, '|');
-            if (tokens.size() != 2)
-              continue;
-
-            baud_rate_table_[std::atoi(tokens[0].c_str())] = std::atoi(tokens[1].c_str());
-          } else if (session == "control table") {
-            std::vector <std::string> tokens = split(input_str, '|');
-            if (tokens.size() != 5)
-              continue;
-
-            ControlTableItem *item = new ControlTableItem;
-            item->item_name = tokens[1];
-            item->address = std::atoi(tokens[0].c_str());
-            item->data_length = std::atoi(tokens[2].c_str());
-            if (tokens[3] == "R")
-              item->access_type = READ;
-            else if (tokens[3] == "RW")
-              item->access_type = READ_WRITE;
-            if (tokens[4] == "EEPROM")
-              item->memory_type = EEPROM;
-            else if (tokens[4] == "RAM")
-              item->memory_type = RAM;
-
-            ctrl_table_[item->item_name] = item;
-          }
+
+          ControlTableItem &item = model.ctrl_table[tokens[1]];
+          item.item_name = tokens[1];
+          item.address = std::atoi(tokens[0].c_str());
+          item.data_length = std::atoi(tokens[2].c_str());
+          if (tokens[3] == "R")
+            item.access_type = READ;
+          else if (tokens[3] == "RW")
+            item.access_type = READ_WRITE;
+          if (tokens[4] == "EEPROM")
+            item.memory_type = EEPROM;
+          else if (tokens[4] == "RAM")
+            item.memory_type = RAM;
         }
-        file.close();
-      } else {
-          std::string msg = "Unable to open .device file: " + item_path_;
-	      throw_control_error(true, msg);
       }
+      return !model.ctrl_table.empty();
+    }
+
+    ControlTableItem *DynamixelTool::findItem(const std::string &item_name) {
+      it_ctrl_ = ctrl_table_.find(item_name);
+      if (it_ctrl_ == ctrl_table_.end())
+        return NULL;
+      return it_ctrl_->second;
+    }
+
+    ControlTableItem *DynamixelTool::getItem(const std::string &item_name) {
+      ControlTableItem *item = findItem(item_name);
+      throw_control_error(item == NULL, "Model " << model_name_ << " has no control table item " << item_name);
+      return item;
+    }
+
+    void DynamixelTool::resolveItems() {
+      // required by every control mode
+      items_.torque_enable = getItem("torque_enable");
+      items_.operating_mode = getItem("operating_mode");
+      items_.goal_position = getItem("goal_position");
+      items_.present_position = getItem("present_position");
+
+      items_.goal_velocity = findItem("goal_velocity");
+      // the X series controls and limits the current instead of the torque
+      items_.goal_torque = findItem("goal_torque");
+      if (!items_.goal_torque)
+        items_.goal_torque = findItem("goal_current");
+      items_.present_velocity = findItem("present_velocity");
+      items_.present_current = findItem("present_current");
+      items_.present_temperature = findItem("present_temperature");
+      items_.hardware_error_status = findItem("hardware_error_status");
+      items_.velocity_limit = findItem("velocity_limit");
+      items_.torque_limit = findItem("torque_limit");
+      if (!items_.torque_limit)
+        items_.torque_limit = findItem("current_limit");
+      items_.external_port_data_1 = findItem("external_port_data_1");
+      items_.indirect_address_1 = findItem("indirect_address_1");
+      items_.indirect_data_1 = findItem("indirect_data_1");
     }
 
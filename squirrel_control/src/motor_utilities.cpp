@@ -6,6 +6,96 @@
 
 
 namespace motor_control {
+
+  static void stateItems(dynamixel_tool::DynamixelTool *tool, dynamixel_tool::ControlTableItem* (&items)[STATE_FIELD_COUNT]) {
+    items[POSITION_FIELD] = tool->items_.present_position;
+    items[VELOCITY_FIELD] = tool->items_.present_velocity;
+    items[CURRENT_FIELD] = tool->items_.present_current;
+    items[HARDWARE_ERROR_FIELD] = tool->items_.hardware_error_status;
+    items[TEMPERATURE_FIELD] = tool->items_.present_temperature;
+  }
+
+
+  static dynamixel_tool::ControlTableItem* goalItem(dynamixel_tool::DynamixelTool *tool, control_modes::ControlMode mode) {
+    switch (mode) {
+    case control_modes::ControlMode::POSITION_MODE:
+      return tool->items_.goal_position;
+    case control_modes::ControlMode::VELOCITY_MODE:
+      return tool->items_.goal_velocity;
+    case control_modes::ControlMode::TORQUE_MODE:
+      return tool->items_.goal_torque;
+    default:
+      return nullptr;
+    }
+  }
+
+
+  static UINT32_T toValue(const UINT8_T *data, UINT8_T length) {
+    switch(length) {
+    case 1:
+      return data[0];
+    case 2:
+      return DXL_MAKEWORD(data[0], data[1]);
+    case 4:
+      return DXL_MAKEDWORD(DXL_MAKEWORD(data[0], data[1]), DXL_MAKEWORD(data[2], data[3]));
+    default:
+      return 0;
+    }
+  }
+
+
+  static int32_t toSigned(UINT32_T value, UINT8_T length) {
+    switch(length) {
+    case 1:
+      return static_cast<int8_t>(value);
+    case 2:
+      return static_cast<int16_t>(value);
+    default:
+      return static_cast<int32_t>(value);
+    }
+  }
+
+  
+  //the PRO series counts symmetrically around 0 rad, the X series from 0 with 0 rad in the middle of the range
+  static double ticksPerRadian(dynamixel_tool::DynamixelTool *tool, bool positive) {
+    return positive ? (tool->value_of_max_radian_position_ - tool->value_of_0_radian_position_) / tool->max_radian_
+      : (tool->value_of_min_radian_position_ - tool->value_of_0_radian_position_) / tool->min_radian_;
+  }
+
+
+  static double toRadian(dynamixel_tool::DynamixelTool *tool, int32_t value) {
+    int32_t ticks = value - tool->value_of_0_radian_position_;
+    return ticks / ticksPerRadian(tool, ticks > 0);
+  }
+
+
+  template <typename GroupRead>
+  static void readValues(GroupRead *group, const Motor &motor, UINT32_T (&values)[STATE_FIELD_COUNT]) {
+    for(int field = 0; field < STATE_FIELD_COUNT; ++field) {
+      values[field] = motor.layout.field_length[field] == 0 ? 0 :
+	group->GetData(motor.id, motor.layout.start_address + motor.layout.field_offset[field], motor.layout.field_length[field]);
+    }
+  }
+
+
+  static bool sameLayout(const StateLayout &a, const StateLayout &b) {
+    if(a.start_address != b.start_address || a.data_length != b.data_length) {
+      return false;
+    }
+    for(int field = 0; field < STATE_FIELD_COUNT; ++field) {
+      if(a.field_offset[field] != b.field_offset[field] || a.field_length[field] != b.field_length[field]) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  
+  //models without a torque_to_current_value_ratio in their .device file (the PRO series) use the common one
+  static double currentPerTorque(dynamixel_tool::DynamixelTool *tool) {
+    return tool->torque_to_current_value_ratio_ > 0 ? tool->torque_to_current_value_ratio_ : 1.0 / MotorUtilities::CURRENT_TO_TORQUE_RATIO_;
+  }
+
   
   MotorUtilities::MotorUtilities() {
   }
@@ -15,8 +105,15 @@ namespace motor_control {
     for(auto const& motor : motors_) {
       delete motor.tool;
     }
+    for(auto const& device : devices_) {
+      delete device.motor.tool;
+    }
+    delete sync_read_;
+    delete bulk_read_;
+    delete sync_write_;
+    delete bulk_write_;
     delete port_handler_;
-    delete packet_handler_;
+    // packet_handler_ is the process wide instance of the protocol, it is shared with other MotorUtilities
   }
   
   
@@ -24,10 +121,6 @@ namespace motor_control {
 
     std::cout << "Switching to mode " << mode << std::endl;
 
-    if (mode == control_modes::ControlMode::VELOCITY_MODE || mode == control_modes::ControlMode::TORQUE_MODE) {
-      throw_control_error(true, "Controller currently only supports position control!");
-    }
-
     disableTorque();
     
     UINT8_T error = 0;
@@ -37,12 +130,17 @@ namespace motor_control {
       current_mode_ = mode;
       for(const auto motor : motors_){
 	comm = packet_handler_->Write1ByteTxRx(port_handler_, motor.id,
-					motor.tool->ctrl_table_["operating_mode"]->address,
+					motor.tool->items_.operating_mode->address,
 					(UINT8_T)current_mode_, &error);
 	if(comm != 0) {
 	  std::cout << "Failed to switch motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") into mode " << mode << std::endl;
 	}
+	//the goal of the previous velocity or torque command survives the switch, start from standstill instead
+	if(current_mode_ != control_modes::ControlMode::POSITION_MODE && goalItem(motor.tool, current_mode_)) {
+	  writeGoalSingle(motor, goalItem(motor.tool, current_mode_), 0);
+	}
       }
+      setupSyncWrite();
       motor_lock_.unlock();
     } catch (std::exception &ex) {
       motor_lock_.unlock();
@@ -61,6 +159,56 @@ namespace motor_control {
   std::vector<Motor> MotorUtilities::getMotors() {
     return motors_;
   }
+
+
+  void MotorUtilities::addDevice(const std::string &name, int id) {
+    device_names_.push_back(name);
+    device_ids_.push_back(id);
+  }
+
+
+  const std::vector<Device>& MotorUtilities::getDevices() {
+    return devices_;
+  }
+
+
+  int MotorUtilities::findDevice(const std::string &name) {
+    for(std::size_t i = 0; i < devices_.size(); ++i) {
+      if(devices_[i].name == name) {
+	return i;
+      }
+    }
+    return -1;
+  }
+
+
+  const std::vector<MotorState>& MotorUtilities::deviceStates() {
+    return device_states_;
+  }
+
+
+  void MotorUtilities::setDeviceGoal(std::size_t device, double position) {
+    throw_control_error(device >= devices_.size(), "Unknown device " << device << ", got " << devices_.size() << " devices");
+    int32_t value = positionValue(devices_[device].motor, position);
+    motor_lock_.lock();
+    device_goals_[device] = value;
+    motor_lock_.unlock();
+  }
+
+
+  std::size_t MotorUtilities::busSize() const {
+    return motors_.size() + devices_.size();
+  }
+
+
+  Motor& MotorUtilities::busMotor(std::size_t index) {
+    return index < motors_.size() ? motors_[index] : devices_[index - motors_.size()].motor;
+  }
+
+
+  MotorState& MotorUtilities::busState(std::size_t index) {
+    return index < motors_.size() ? motor_states_[index] : device_states_[index - motors_.size()];
+  }
   
   
   bool MotorUtilities::motorsReady() {
@@ -71,10 +219,72 @@ namespace motor_control {
   bool MotorUtilities::torqueEnabled() {
     return torque_enabled_;
   }
+
+
+  void MotorUtilities::setSyncRead(bool enabled) {
+    sync_read_enabled_ = enabled;
+  }
+
+
+  bool MotorUtilities::syncReadEnabled() {
+    return sync_read_enabled_ && (sync_read_ != nullptr || bulk_read_ != nullptr);
+  }
+
+
+  void MotorUtilities::setSyncWrite(bool enabled) {
+    sync_write_enabled_ = enabled;
+  }
+
+
+  bool MotorUtilities::syncWriteEnabled() {
+    return sync_write_enabled_ && (sync_write_ != nullptr || bulk_write_ != nullptr);
+  }
+
+
+  void MotorUtilities::setIndirectRead(bool enabled) {
+    indirect_read_enabled_ = enabled;
+  }
+
+
+  bool MotorUtilities::indirectReadEnabled() {
+    return indirect_read_active_;
+  }
+
+
+  void MotorUtilities::setPipelinedRead(bool enabled) {
+    pipelined_read_enabled_ = enabled;
+  }
+
+
+  bool MotorUtilities::pipelinedReadEnabled() {
+    return pipelined_read_enabled_ && syncReadEnabled();
+  }
+
+
+  void MotorUtilities::setBlockingRead(bool enabled) {
+    blocking_read_ = enabled;
+  }
+
+
+  void MotorUtilities::setLowLatency(bool enabled) {
+    low_latency_ = enabled;
+  }
+
+
+  const squirrel_control::LatencyHistogram& MotorUtilities::busReadTiming() const {
+    return bus_read_timing_;
+  }
+
+
+  const squirrel_control::LatencyHistogram& MotorUtilities::busWriteTiming() const {
+    return bus_write_timing_;
+  }
   
   
   bool MotorUtilities::initMotors(std::string motor_port, std::vector<int> motors) {
     port_handler_ = ROBOTIS::PortHandler::GetPortHandler(motor_port.c_str());
+    port_handler_->SetBlockingRead(blocking_read_);
+    port_handler_->SetLowLatency(low_latency_);
     if (!port_handler_->OpenPort()) {
       throw_control_error(true, "Failed to open motor port!");
     }		
@@ -88,36 +298,282 @@ namespace motor_control {
     motors_ = std::vector<Motor>();
     
     uint8_t dynamixel_error = 0;
-    int dynamixel_id = 0;
-    uint16_t dynamixel_num = 0;
-    
-    for(dynamixel_id = 1; dynamixel_id < 253; dynamixel_id++) {
-      if (packet_handler_->Ping(port_handler_, dynamixel_id, &dynamixel_num, &dynamixel_error) == 0) {
-	std::cout << "Found model: " << dynamixel_num << " with id " << dynamixel_id << std::endl;
-	dynamixel_tool::DynamixelTool* tool = new dynamixel_tool::DynamixelTool(dynamixel_id, dynamixel_num, 2.0);
-	Motor motor_;
-	motor_.id = dynamixel_id;
-	motor_.tool = tool;
+
+    //a single broadcast ping finds every motor on the bus, the configured IDs that did not answer it are pinged once more
+    std::vector<UINT8_T> found_ids;
+    std::vector<UINT16_T> found_models;
+    if (packet_handler_->BroadcastPing(port_handler_, found_ids, found_models) != 0) {
+      std::cout << "Broadcast ping failed, pinging the configured motors one by one" << std::endl;
+    }
+    if (motors.empty()) {
+      for(UINT8_T id : found_ids) {
+	if (std::find(device_ids_.begin(), device_ids_.end(), id) == device_ids_.end()) {
+	  motors.push_back(id);
+	}
+      }
+    }
+
+    auto createMotor = [&](int dynamixel_id, Motor &motor_) {
+      uint16_t dynamixel_num = 0;
+      std::vector<UINT8_T>::iterator found = std::find(found_ids.begin(), found_ids.end(), dynamixel_id);
+      if (found != found_ids.end()) {
+	dynamixel_num = found_models[found - found_ids.begin()];
+      } else if (packet_handler_->Ping(port_handler_, dynamixel_id, &dynamixel_num, &dynamixel_error) != 0) {
+	std::cout << "Motor with id " << dynamixel_id << " did not answer" << std::endl;
+	return false;
+      }
+      std::cout << "Found model: " << dynamixel_num << " with id " << dynamixel_id << std::endl;
+      //the control table of each model is parsed only once and shared between the tools
+      motor_.id = dynamixel_id;
+      motor_.tool = new dynamixel_tool::DynamixelTool(dynamixel_id, dynamixel_num, 2.0);
+      readLimits(motor_);
+      return true;
+    };
+
+    for(int dynamixel_id : motors) {
+      Motor motor_;
+      if (createMotor(dynamixel_id, motor_)) {
 	motors_.push_back(motor_);
-      } 
-    }	
+      }
+    }
     std::cout << "Found " << motors_.size() << " motors" << std::endl;
+
+    devices_.clear();
+    device_goals_.clear();
+    for(std::size_t i = 0; i < device_ids_.size(); ++i) {
+      Device device;
+      device.name = device_names_[i];
+      if (!createMotor(device_ids_[i], device.motor)) {
+	continue;
+      }
+      Motor &motor = device.motor;
+      dynamixel_tool::ControlTableItem *position = motor.tool->items_.present_position;
+      UINT8_T data[4] = {0, 0, 0, 0};
+      //the device holds its present position until the first goal is set
+      if (!position || !motor.tool->items_.goal_position ||
+	  packet_handler_->ReadTxRx(port_handler_, motor.id, position->address, position->data_length, data, &error) != 0) {
+	std::cout << "Failed to read the position of device " << device.name << " (" << motor.tool->model_name_ << "), device ignored" << std::endl;
+	delete motor.tool;
+	continue;
+      }
+      //devices are always position controlled, the operating mode is only writable with torque disabled
+      packet_handler_->Write1ByteTxRx(port_handler_, motor.id, motor.tool->items_.torque_enable->address, 0, &error);
+      packet_handler_->Write1ByteTxRx(port_handler_, motor.id, motor.tool->items_.operating_mode->address,
+				      (UINT8_T)control_modes::ControlMode::POSITION_MODE, &error);
+      devices_.push_back(device);
+      device_goals_.push_back(toSigned(toValue(data, position->data_length), position->data_length));
+    }
+    if (!device_ids_.empty()) {
+      std::cout << "Found " << devices_.size() << " devices" << std::endl;
+    }
+    setupStateRead();
+    setupSyncWrite();
     return true;
   }
-  
-  
+
+
+  void MotorUtilities::readLimits(Motor &motor) {
+    UINT8_T error = 0;
+    UINT8_T data[4] = {0, 0, 0, 0};
+    //the limits live in EEPROM and cannot change while torque is enabled, so they are read once instead of per command
+    dynamixel_tool::ControlTableItem *items[2] = {motor.tool->items_.velocity_limit, motor.tool->items_.torque_limit};
+    int32_t *limits[2] = {&motor.velocity_limit, &motor.torque_limit};
+    for(int i = 0; i < 2; ++i) {
+      *limits[i] = -1;
+      if(!items[i]) {
+	continue;
+      }
+      if(packet_handler_->ReadTxRx(port_handler_, motor.id, items[i]->address, items[i]->data_length, data, &error) != 0) {
+	std::cout << "Failed to read " << items[i]->item_name << " for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
+	continue;
+      }
+      *limits[i] = static_cast<int32_t>(toValue(data, items[i]->data_length));
+    }
+  }
+
+
+  bool MotorUtilities::setupStateRead() {
+    discardStateRequest();
+    delete sync_read_;
+    sync_read_ = nullptr;
+    delete bulk_read_;
+    bulk_read_ = nullptr;
+    indirect_read_active_ = false;
+    state_read_ready_ = false;
+    motor_states_.assign(motors_.size(), MotorState());
+    device_states_.assign(devices_.size(), MotorState());
+
+    if(busSize() == 0) {
+      return false;
+    }
+
+    //indirect addressing is used for all motors or none, so that every motor reports the same fields
+    bool indirect = indirect_read_enabled_;
+    for(std::size_t i = 0; indirect && i < busSize(); ++i) {
+      indirect = stateLayout(busMotor(i), true, busMotor(i).layout) && setupIndirectRead(busMotor(i));
+    }
+
+    std::size_t buffer_length = 0;
+    for(std::size_t i = 0; i < busSize(); ++i) {
+      Motor &motor = busMotor(i);
+      if(!indirect && !stateLayout(motor, false, motor.layout)) {
+	return false;
+      }
+      buffer_length = std::max<std::size_t>(buffer_length, motor.layout.data_length);
+    }
+    indirect_read_active_ = indirect;
+    state_read_ready_ = true;
+    state_buffer_.resize(buffer_length);
+
+    //SYNC_READ asks every motor for the same address range, a BULK_READ asks each motor for its own one
+    bool common = true;
+    for(std::size_t i = 1; common && i < busSize(); ++i) {
+      common = sameLayout(busMotor(0).layout, busMotor(i).layout);
+    }
+    if(common) {
+      sync_read_ = new ROBOTIS::GroupSyncRead(port_handler_, packet_handler_, busMotor(0).layout.start_address, busMotor(0).layout.data_length);
+      for(std::size_t i = 0; i < busSize(); ++i) {
+	sync_read_->AddParam(busMotor(i).id);
+      }
+    } else {
+      std::cout << "Motors have different control table layouts, reading them with bulk read" << std::endl;
+      bulk_read_ = new ROBOTIS::GroupBulkRead(port_handler_, packet_handler_);
+      for(std::size_t i = 0; i < busSize(); ++i) {
+	const Motor &motor = busMotor(i);
+	bulk_read_->AddParam(motor.id, motor.layout.start_address, motor.layout.data_length);
+      }
+    }
+    return true;
+  }
+
+
+  bool MotorUtilities::stateLayout(const Motor &motor, bool indirect, StateLayout &layout) {
+    const char* field_names[STATE_FIELD_COUNT] = {"present_position", "present_velocity", "present_current",
+						  "hardware_error_status", "present_temperature"};
+    //without indirect addressing only the contiguous position, velocity and current block is read
+    int field_count = indirect ? STATE_FIELD_COUNT : HARDWARE_ERROR_FIELD;
+
+    dynamixel_tool::ControlTableItem* items[STATE_FIELD_COUNT];
+    stateItems(motor.tool, items);
+    for(int field = 0; field < field_count; ++field) {
+      if(!items[field]) {
+	std::cout << "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") does not provide " << field_names[field]
+		  << (indirect ? ", indirect read disabled" : ", state read disabled") << std::endl;
+	return false;
+      }
+    }
+
+    for(int field = 0; field < STATE_FIELD_COUNT; ++field) {
+      layout.field_offset[field] = 0;
+      layout.field_length[field] = 0;
+    }
+
+    if(indirect) {
+      if(!motor.tool->items_.indirect_address_1 || !motor.tool->items_.indirect_data_1) {
+	std::cout << "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") does not support indirect addressing, indirect read disabled" << std::endl;
+	return false;
+      }
+      //the indirect data region holds the fields back to back in the order of StateField
+      UINT16_T offset = 0;
+      for(int field = 0; field < STATE_FIELD_COUNT; ++field) {
+	layout.field_offset[field] = offset;
+	layout.field_length[field] = items[field]->data_length;
+	offset += items[field]->data_length;
+      }
+      layout.start_address = motor.tool->items_.indirect_data_1->address;
+      layout.data_length = offset;
+    } else {
+      UINT16_T start = items[POSITION_FIELD]->address;
+      UINT16_T end = items[POSITION_FIELD]->address + items[POSITION_FIELD]->data_length;
+      for(int field = 0; field < HARDWARE_ERROR_FIELD; ++field) {
+	start = std::min<UINT16_T>(start, items[field]->address);
+	end = std::max<UINT16_T>(end, items[field]->address + items[field]->data_length);
+      }
+      for(int field = 0; field < HARDWARE_ERROR_FIELD; ++field) {
+	layout.field_offset[field] = items[field]->address - start;
+	layout.field_length[field] = items[field]->data_length;
+      }
+      layout.start_address = start;
+      layout.data_length = end - start;
+    }
+    return true;
+  }
+
+
+  bool MotorUtilities::setupIndirectRead(const Motor &motor) {
+    UINT8_T error = 0;
+    int comm = 0;
+
+    //one indirect address entry per byte of each field
+    dynamixel_tool::ControlTableItem* items[STATE_FIELD_COUNT];
+    stateItems(motor.tool, items);
+    std::vector<UINT16_T> addresses;
+    for(int field = 0; field < STATE_FIELD_COUNT; ++field) {
+      for(UINT16_T byte = 0; byte < items[field]->data_length; ++byte) {
+	addresses.push_back(items[field]->address + byte);
+      }
+    }
+
+    //reads the table back, true if every entry points at its state byte
+    dynamixel_tool::ControlTableItem *indirect_address = motor.tool->items_.indirect_address_1;
+    std::vector<UINT8_T> table(addresses.size() * 2);
+    auto programmed = [&]() {
+      bool matches = packet_handler_->ReadTxRx(port_handler_, motor.id, indirect_address->address, table.size(),
+					       table.data(), &error) == 0 && error == 0;
+      for(std::size_t i = 0; matches && i < addresses.size(); ++i) {
+	matches = DXL_MAKEWORD(table[2 * i], table[2 * i + 1]) == addresses[i];
+      }
+      return matches;
+    };
+
+    //skip motors that are already set up, the table lives in EEPROM on some models
+    if(programmed()) {
+      return true;
+    }
+
+    std::cout << "Programming indirect addresses of motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
+    //EEPROM is only writable with torque disabled
+    packet_handler_->Write1ByteTxRx(port_handler_, motor.id, motor.tool->items_.torque_enable->address, 0, &error);
+    for(std::size_t i = 0; i < addresses.size(); ++i) {
+      comm = packet_handler_->Write2ByteTxRx(port_handler_, motor.id, indirect_address->address + 2 * i, addresses[i], &error);
+      if(comm != 0 || error != 0) {
+	std::cout << "Failed to set indirect address for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << "), indirect read disabled" << std::endl;
+	return false;
+      }
+    }
+
+    //a motor may acknowledge writes it did not apply
+    if(!programmed()) {
+      std::cout << "Indirect addresses of motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") do not read back as written, indirect read disabled" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+
   bool MotorUtilities::startMotors() {
+    discardStateRequest();
     UINT8_T error = 0;
     int comm = 0;
     enableTorque();
     for(auto const& motor: motors_) {
       std::cout << "Starting motor " << static_cast<int>(motor.id)<< std::endl;
-      comm = packet_handler_->Write2ByteTxRx(port_handler_, motor.id, motor.tool->ctrl_table_["external_port_data_1"]->address, 4095, &error);
+      if(!motor.tool->items_.external_port_data_1) {
+	std::cout << "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") has no brake port" << std::endl;
+	continue;
+      }
+      comm = packet_handler_->Write2ByteTxRx(port_handler_, motor.id, motor.tool->items_.external_port_data_1->address, 4095, &error);
       if(comm != 0) {
 	std::cout << "Failed to loosen brakes for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
       }
 
     }
+    for(auto const& device: devices_) {
+      comm = packet_handler_->Write1ByteTxRx(port_handler_, device.motor.id, device.motor.tool->items_.torque_enable->address, 1, &error);
+      if(comm != 0) {
+	std::cout << "Failed to enable torque for device " << device.name << " (" << device.motor.tool->model_name_ << ")" << std::endl;
+      }
+    }
     motors_ready_ = true;
     std::cout << "Motors started." << std::endl;
     return true;
@@ -125,14 +581,24 @@ namespace motor_control {
   
   
   bool MotorUtilities::stopMotors() {
+    discardStateRequest();
     UINT8_T error = 0;
     int comm = 0;
     for(auto const& motor: motors_) {
-      comm = packet_handler_->Write2ByteTxRx(port_handler_, motor.id, motor.tool->ctrl_table_["external_port_data_1"]->address, 0, &error);
+      if(!motor.tool->items_.external_port_data_1) {
+	continue;
+      }
+      comm = packet_handler_->Write2ByteTxRx(port_handler_, motor.id, motor.tool->items_.external_port_data_1->address, 0, &error);
       if(comm != 0) {
 	std::cout << "Failed to set brakes for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
       }
     }
+    for(auto const& device: devices_) {
+      comm = packet_handler_->Write1ByteTxRx(port_handler_, device.motor.id, device.motor.tool->items_.torque_enable->address, 0, &error);
+      if(comm != 0) {
+	std::cout << "Failed to disable torque for device " << device.name << " (" << device.motor.tool->model_name_ << ")" << std::endl;
+      }
+    }
     motors_ready_ = false;
     disableTorque();
     return true;
@@ -140,10 +606,11 @@ namespace motor_control {
   
   
   bool MotorUtilities::enableTorque() {
+    discardStateRequest();
     UINT8_T error = 0;
     int comm = 0;
     for(auto const& motor: motors_) {
-      comm = packet_handler_->Write1ByteTxRx(port_handler_, motor.id, motor.tool->ctrl_table_["torque_enable"]->address, 1, &error);
+      comm = packet_handler_->Write1ByteTxRx(port_handler_, motor.id, motor.tool->items_.torque_enable->address, 1, &error);
       if(comm != 0) {
 	std::cout << "Failed to enable torque for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
       }
@@ -154,10 +621,11 @@ namespace motor_control {
   
   
   bool MotorUtilities::disableTorque() {
+    discardStateRequest();
     UINT8_T error = 0;
     int comm = 0;
     for(auto const& motor: motors_) {
-      comm = packet_handler_->Write1ByteTxRx(port_handler_, motor.id, motor.tool->ctrl_table_["torque_enable"]->address, 0, &error);
+      comm = packet_handler_->Write1ByteTxRx(port_handler_, motor.id, motor.tool->items_.torque_enable->address, 0, &error);
       if(comm != 0) {
 	std::cout << "Failed to disable torque for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
       }
@@ -167,12 +635,10 @@ namespace motor_control {
   }
   
   
-  bool MotorUtilities::write(std::vector<double> commands)
+  bool MotorUtilities::write(const std::vector<double> &commands)
   {
     throw_control_error(commands.size() != motors_.size(), "Wrong number of commands! Got " << commands.size() << ", but expected " << motors_.size());
     
-    int i = 0;
-    UINT8_T error = 0;
     int comm = 0;
     
     motor_lock_.lock();
@@ -180,68 +646,44 @@ namespace motor_control {
     //we throw a bunch of own exceptions - let's catch them all and forward them to at all times release the lock
     //Motor 3 has an offset of 228000 ticks - we do not have to treat that one, the dynamiel formware takes care of that
     try {
-      for (auto const motor : motors_) {
-	switch (current_mode_) {
-	case control_modes::ControlMode::POSITION_MODE: {
-	  double rad_per_tick = motor.tool->max_radian_ / motor.tool->value_of_max_radian_position_;
-	  int goal_position =  static_cast<int>(commands.at(i) / rad_per_tick);
-	  int min_ = motor.tool->value_of_min_radian_position_;
-	  int max_ = motor.tool->value_of_max_radian_position_;
-	  throw_control_error(goal_position < min_ || goal_position > max_,
-			      "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_
-			      << ") exceeds its limits [" << min_ << "," << max_
-			      << "] with goal position: " << goal_position);
-
-	  comm = packet_handler_->Write4ByteTxRx(port_handler_, motor.id,
-					  motor.tool->ctrl_table_["goal_position"]->address,
-					  goal_position, &error);	  
-	}
-	  break;
-	  
-	case control_modes::ControlMode::VELOCITY_MODE: {
-	  UINT32_T velocity_limit;
-	  comm = packet_handler_->Read4ByteTxRx(port_handler_, motor.id,
-					 motor.tool->ctrl_table_["velocity_limit"]->address,
-					 &velocity_limit, &error);
-	  if(comm != 0) {
-	    std::cout << "Failed to read velocity limit for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
-	  }
-	  UINT32_T commanded_velocity = (UINT32_T)commands.at(i);
-	  throw_control_error( commanded_velocity > velocity_limit,
-			       "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_
-			       << ") exceeds its velocity [" << velocity_limit << "] with commanded velocity: " << commanded_velocity);
-	  comm = packet_handler_->Write4ByteTxRx(port_handler_, motor.id,
-					  motor.tool->ctrl_table_["goal_velocity"]->address,
-					  commanded_velocity, &error);
-	}
-	  break;
-	  
-	case control_modes::ControlMode::TORQUE_MODE: {
-	  UINT16_T torque_limit;
-	  comm = packet_handler_->Read2ByteTxRx(port_handler_, motor.id,
-					 motor.tool->ctrl_table_["torque_limit"]->address,
-					 &torque_limit, &error);
-	  if(comm != 0) {
-	    std::cout << "Failed to read torque limit for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
+      //check all commands against the motor limits before anything is sent, the devices follow the arm motors
+      for (std::size_t i = 0; i < motors_.size(); ++i) {
+	goal_values_[i] = goalValue(motors_[i], commands.at(i));
+      }
+      std::copy(device_goals_.begin(), device_goals_.end(), goal_values_.begin() + motors_.size());
+      //a request of the last write() that no readStates() collected would keep the port busy
+      discardStateRequest();
+
+      if (syncWriteEnabled()) {
+	for (std::size_t i = 0; i < busSize(); ++i) {
+	  UINT32_T value = static_cast<UINT32_T>(goal_values_[i]);
+	  UINT8_T data[4] = { DXL_LOBYTE(DXL_LOWORD(value)), DXL_HIBYTE(DXL_LOWORD(value)),
+			      DXL_LOBYTE(DXL_HIWORD(value)), DXL_HIBYTE(DXL_HIWORD(value)) };
+	  if (sync_write_ != nullptr) {
+	    sync_write_->ChangeParam(busMotor(i).id, data);
+	  } else {
+	    bulk_write_->ChangeParam(busMotor(i).id, goal_items_[i]->address, goal_items_[i]->data_length, data);
 	  }
-	  UINT16_T commanded_torque = (UINT16_T)commands.at(i);
-	  throw_control_error( commanded_torque > torque_limit,
-			       "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_
-			       << ") exceeds its velocity [" << torque_limit << "] with commanded velocity: " << commanded_torque);
-	  comm = packet_handler_->Write2ByteTxRx(port_handler_, motor.id,
-					  motor.tool->ctrl_table_["goal_torque"]->address,
-					  commanded_torque, &error);
 	}
-	  break;
-	  
-	default:
-	  throw_control_error(true, "Unknown mode: " << current_mode_);
-	}
-	//this theoretically should never be evaluated, but for sake of completeness...
+	struct timespec start = squirrel_control::LatencyHistogram::now();
+	comm = sync_write_ != nullptr ? sync_write_->TxPacket() : bulk_write_->TxPacket();
+	bus_write_timing_.recordSince(start);
 	if(comm != 0){
-	  std::cout << "Failed to command motor " << static_cast<int>(motor.id) <<  " (" << motor.tool->model_name_ << ") in mode " << current_mode_ << std::endl;
+	  std::cout << "Failed to command motors in mode " << current_mode_ << std::endl;
+	}
+	requestStates();
+      } else {
+	for (std::size_t i = 0; i < busSize(); ++i) {
+	  const Motor &motor = busMotor(i);
+	  struct timespec start = squirrel_control::LatencyHistogram::now();
+	  comm = writeGoalSingle(motor, goal_items_[i], goal_values_[i]);
+	  bus_write_timing_.recordSince(start);
+	  //this theoretically should never be evaluated, but for sake of completeness...
+	  if(comm != 0){
+	    std::cout << "Failed to command motor " << static_cast<int>(motor.id) <<  " (" << motor.tool->model_name_ << ") in mode " << current_mode_ << std::endl;
+	  }
 	}
-	i++;
+	requestStates();
       }
     } catch(const std::exception &ex) {
       motor_lock_.unlock();
@@ -257,70 +699,282 @@ namespace motor_control {
     }
     return true;
   }
-  
-  
-  std::vector<double> MotorUtilities::read() {
-    UINT8_T error = 0;    
-    int comm = 0;
-    switch(current_mode_) {
+
+
+  int32_t MotorUtilities::goalValue(const Motor &motor, double command) {
+    switch (current_mode_) {
     case control_modes::ControlMode::POSITION_MODE:
-      {
-	std::vector<double> positions = {};
-	UINT32_T value;
-	for (auto const motor : motors_) {
-	  comm = -1;
-          int counter =0;
-	  while(comm != 0) {
-            counter++;
-	    comm = packet_handler_->Read4ByteTxRx(port_handler_, motor.id,
-					 motor.tool->ctrl_table_["present_position"]->address,
-					 &value, &error);
-	    if(comm != 0) {
-	      std::cout << "Error reading position for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
-	    }
-            if(counter > 10) {
-	      throw_control_error(true, "Really cant read from motor");	
-	    }
-          }
-	  double rad_per_tick = motor.tool->max_radian_ / motor.tool->value_of_max_radian_position_;
-	  int real_value = static_cast<int>(value);
-	  positions.push_back(double(real_value*rad_per_tick));
-	}
-	
-	return positions;
+      return positionValue(motor, command);
+
+    case control_modes::ControlMode::VELOCITY_MODE: {
+      throw_control_error(motor.velocity_limit < 0,
+			  "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") has no velocity limit");
+      int32_t goal_velocity = static_cast<int32_t>(round(command * motor.tool->velocity_to_value_ratio_));
+      throw_control_error(std::abs(goal_velocity) > motor.velocity_limit,
+			  "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_
+			  << ") exceeds its velocity limit [" << motor.velocity_limit << "] with goal velocity: " << goal_velocity);
+      return goal_velocity;
+    }
+
+    case control_modes::ControlMode::TORQUE_MODE: {
+      throw_control_error(motor.torque_limit < 0,
+			  "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") has no torque limit");
+      int32_t goal_current = static_cast<int32_t>(round(command * currentPerTorque(motor.tool)));
+      throw_control_error(std::abs(goal_current) > motor.torque_limit,
+			  "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_
+			  << ") exceeds its torque limit [" << motor.torque_limit << "] with goal current: " << goal_current);
+      return goal_current;
+    }
+
+    default:
+      throw_control_error(true, "Unknown mode: " << current_mode_);
+    }
+    return 0;
+  }
+
+
+  int32_t MotorUtilities::positionValue(const Motor &motor, double position) {
+    int goal_position = motor.tool->value_of_0_radian_position_ + static_cast<int>(position * ticksPerRadian(motor.tool, position > 0));
+    int min_ = motor.tool->value_of_min_radian_position_;
+    int max_ = motor.tool->value_of_max_radian_position_;
+    throw_control_error(goal_position < min_ || goal_position > max_,
+			"Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_
+			<< ") exceeds its limits [" << min_ << "," << max_
+			<< "] with goal position: " << goal_position);
+    return goal_position;
+  }
+
+
+  int MotorUtilities::writeGoalSingle(const Motor &motor, dynamixel_tool::ControlTableItem *item, int32_t value) {
+    UINT8_T error = 0;
+    throw_control_error(!item, "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") has no goal for mode " << current_mode_);
+    switch (item->data_length) {
+    case 2:
+      return packet_handler_->Write2ByteTxRx(port_handler_, motor.id, item->address, static_cast<UINT16_T>(value), &error);
+    case 4:
+      return packet_handler_->Write4ByteTxRx(port_handler_, motor.id, item->address, static_cast<UINT32_T>(value), &error);
+    default:
+      throw_control_error(true, "Unsupported goal length " << static_cast<int>(item->data_length) << " of motor " << static_cast<int>(motor.id));
+    }
+    return -1;
+  }
+
+
+  bool MotorUtilities::setupSyncWrite() {
+    delete sync_write_;
+    sync_write_ = nullptr;
+    delete bulk_write_;
+    bulk_write_ = nullptr;
+
+    //devices are position controlled whatever the mode of the arm is
+    goal_items_.resize(busSize());
+    goal_values_.resize(busSize());
+    for(std::size_t i = 0; i < busSize(); ++i) {
+      goal_items_[i] = goalItem(busMotor(i).tool, i < motors_.size() ? current_mode_ : control_modes::ControlMode::POSITION_MODE);
+    }
+
+    if(busSize() == 0) {
+      return false;
+    }
+
+    bool common = true;
+    for(std::size_t i = 0; i < busSize(); ++i) {
+      const Motor &motor = busMotor(i);
+      if(!goal_items_[i]) {
+	std::cout << "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") has no goal for mode " << current_mode_ << ", sync write disabled" << std::endl;
+	return false;
       }
-    case control_modes::ControlMode::VELOCITY_MODE:
-      {
-	std::vector<double> velocities = {};
-	UINT32_T value;
-	for (auto const motor : motors_) {
-	  comm = packet_handler_->Read4ByteTxRx(port_handler_, motor.id,
-					 motor.tool->ctrl_table_["present_velocity"]->address,
-					 &value, &error);
-	  if(comm != 0) {
-	    std::cout << "Error reading velocity for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
+      common = common && goal_items_[i]->address == goal_items_[0]->address && goal_items_[i]->data_length == goal_items_[0]->data_length;
+    }
+
+    //SYNC_WRITE sends the same address range to every motor, a BULK_WRITE sends each motor its own one
+    UINT8_T data[4] = {0, 0, 0, 0};
+    if(common) {
+      sync_write_ = new ROBOTIS::GroupSyncWrite(port_handler_, packet_handler_, goal_items_[0]->address, goal_items_[0]->data_length);
+      for(std::size_t i = 0; i < busSize(); ++i) {
+	sync_write_->AddParam(busMotor(i).id, data);
+      }
+    } else {
+      std::cout << "Motors have different goal addresses in mode " << current_mode_ << ", writing them with bulk write" << std::endl;
+      bulk_write_ = new ROBOTIS::GroupBulkWrite(port_handler_, packet_handler_);
+      for(std::size_t i = 0; i < busSize(); ++i) {
+	bulk_write_->AddParam(busMotor(i).id, goal_items_[i]->address, goal_items_[i]->data_length, data);
+      }
+    }
+    return true;
+  }
+
+
+  const std::vector<MotorState>& MotorUtilities::readStates() {
+    throw_control_error(!state_read_ready_, "Motors do not provide present position, velocity and current");
+
+    bool batched = syncReadEnabled();
+    if(batched) {
+      //per-motor results are checked below, a single failing motor does not invalidate the whole batch
+      struct timespec start = squirrel_control::LatencyHistogram::now();
+      if(state_request_pending_) {
+	//the request went out at the end of the last write(), the status packets are most likely buffered already
+	state_request_pending_ = false;
+	sync_read_ != nullptr ? sync_read_->RxPacket() : bulk_read_->RxPacket();
+      } else {
+	sync_read_ != nullptr ? sync_read_->TxRxPacket() : bulk_read_->TxRxPacket();
+      }
+      bus_read_timing_.recordSince(start);
+    }
+
+    UINT32_T values[STATE_FIELD_COUNT];
+    for(std::size_t i = 0; i < busSize(); ++i) {
+      const Motor &motor = busMotor(i);
+      MotorState &state = busState(i);
+      if(batched) {
+	state.comm_result = sync_read_ != nullptr ? sync_read_->GetResult(motor.id) : bulk_read_->GetResult(motor.id);
+	if(state.comm_result == COMM_SUCCESS) {
+	  if(sync_read_ != nullptr) {
+	    readValues(sync_read_, motor, values);
+	  } else {
+	    readValues(bulk_read_, motor, values);
 	  }
-	  velocities.push_back(double(value));
+	  decodeState(motor, values, state);
+	  continue;
 	}
-	return velocities;
+	std::cout << "Batched read failed for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << "), reading it separately" << std::endl;
       }
-    case control_modes::ControlMode::TORQUE_MODE:
-      {
-	std::vector<double> torques = {};
-	UINT16_T value;
-	for (auto const motor : motors_) {
-	  comm = packet_handler_->Read2ByteTxRx(port_handler_, motor.id,
-					 motor.tool->ctrl_table_["present_current"]->address,
-					 &value, &error);
-	  if(comm != 0) {
-	    std::cout << "Error reading torque for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
-	  }
-	  torques.push_back(abs(double(value)*CURRENT_TO_TORQUE_RATIO_));
+      readStateSingle(motor, state);
+    }
+    return motor_states_;
+  }
+
+
+  void MotorUtilities::requestStates() {
+    if(!pipelinedReadEnabled() || !state_read_ready_) {
+      return;
+    }
+    //SYNC_WRITE and BULK_WRITE have no status packets, so the bus is free as soon as the goals are out
+    int comm = sync_read_ != nullptr ? sync_read_->TxPacket() : bulk_read_->TxPacket();
+    state_request_pending_ = comm == COMM_SUCCESS;
+  }
+
+
+  void MotorUtilities::discardStateRequest() {
+    //the port stays busy until the status packets of a pending SYNC_READ or BULK_READ are received
+    if(state_request_pending_) {
+      state_request_pending_ = false;
+      sync_read_ != nullptr ? sync_read_->RxPacket() : bulk_read_->RxPacket();
+    }
+  }
+
+
+  bool MotorUtilities::readStateSingle(const Motor &motor, MotorState &state) {
+    UINT8_T error = 0;
+    int counter = 0;
+    state.comm_result = -1;
+    while(state.comm_result != 0) {
+      counter++;
+      struct timespec start = squirrel_control::LatencyHistogram::now();
+      state.comm_result = packet_handler_->ReadTxRx(port_handler_, motor.id, motor.layout.start_address, motor.layout.data_length,
+						     state_buffer_.data(), &error);
+      bus_read_timing_.recordSince(start);
+      if(state.comm_result != 0) {
+	std::cout << "Error reading state for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
+      }
+      if(counter > 10) {
+	throw_control_error(true, "Really cant read from motor");
+      }
+    }
+    UINT32_T values[STATE_FIELD_COUNT];
+    for(int field = 0; field < STATE_FIELD_COUNT; ++field) {
+      values[field] = toValue(&state_buffer_[motor.layout.field_offset[field]], motor.layout.field_length[field]);
+    }
+    decodeState(motor, values, state);
+    return true;
+  }
+
+
+  void MotorUtilities::decodeState(const Motor &motor, const UINT32_T (&values)[STATE_FIELD_COUNT], MotorState &state) {
+    state.position = toRadian(motor.tool, toSigned(values[POSITION_FIELD], motor.layout.field_length[POSITION_FIELD]));
+    state.velocity = toSigned(values[VELOCITY_FIELD], motor.layout.field_length[VELOCITY_FIELD]) / motor.tool->velocity_to_value_ratio_;
+    state.effort = toSigned(values[CURRENT_FIELD], motor.layout.field_length[CURRENT_FIELD]) / currentPerTorque(motor.tool);
+    state.hardware_error = values[HARDWARE_ERROR_FIELD];
+    state.temperature = values[TEMPERATURE_FIELD];
+  }
+
+
+  std::vector<double> MotorUtilities::read() {
+    std::vector<double> values;
+    read(values);
+    return values;
+  }
+
+
+  void MotorUtilities::read(std::vector<double> &values) {
+    //every mode is served by the same state read, with sync read enabled that is a single transaction
+    if(state_read_ready_) {
+      const std::vector<MotorState> &states = readStates();
+      values.resize(states.size());
+      for(std::size_t i = 0; i < states.size(); ++i) {
+	switch(current_mode_) {
+	case control_modes::ControlMode::POSITION_MODE:
+	  values[i] = states[i].position;
+	  break;
+	case control_modes::ControlMode::VELOCITY_MODE:
+	  values[i] = states[i].velocity;
+	  break;
+	case control_modes::ControlMode::TORQUE_MODE:
+	  values[i] = states[i].effort;
+	  break;
+	default:
+	  throw_control_error(true, "Unknown mode: " << current_mode_);
 	}
-	return torques;
       }
-    default:
-      throw_control_error(true, "Unknown mode: " << current_mode_);
+      return;
+    }
+
+    //the motors cannot be read as one block, read the quantity of the current mode from each of them
+    UINT8_T error = 0;
+    UINT8_T data[4] = {0, 0, 0, 0};
+    values.clear();
+    for (auto const motor : motors_) {
+      dynamixel_tool::ControlTableItem *item = nullptr;
+      switch(current_mode_) {
+      case control_modes::ControlMode::POSITION_MODE:
+	item = motor.tool->items_.present_position;
+	break;
+      case control_modes::ControlMode::VELOCITY_MODE:
+	item = motor.tool->items_.present_velocity;
+	break;
+      case control_modes::ControlMode::TORQUE_MODE:
+	item = motor.tool->items_.present_current;
+	break;
+      default:
+	throw_control_error(true, "Unknown mode: " << current_mode_);
+      }
+      throw_control_error(!item, "Motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ") cannot be read in mode " << current_mode_);
+
+      int comm = -1;
+      int counter = 0;
+      while(comm != 0) {
+	counter++;
+	struct timespec start = squirrel_control::LatencyHistogram::now();
+	comm = packet_handler_->ReadTxRx(port_handler_, motor.id, item->address, item->data_length, data, &error);
+	bus_read_timing_.recordSince(start);
+	if(comm != 0) {
+	  std::cout << "Error reading " << item->item_name << " for motor " << static_cast<int>(motor.id) << " (" << motor.tool->model_name_ << ")" << std::endl;
+	}
+	if(counter > 10) {
+	  throw_control_error(true, "Really cant read from motor");
+	}
+      }
+      int32_t value = toSigned(toValue(data, item->data_length), item->data_length);
+      switch(current_mode_) {
+      case control_modes::ControlMode::POSITION_MODE:
+	values.push_back(toRadian(motor.tool, value));
+	break;
+      case control_modes::ControlMode::VELOCITY_MODE:
+	values.push_back(value / motor.tool->velocity_to_value_ratio_);
+	break;
+      default:
+	values.push_back(value / currentPerTorque(motor.tool));
+      }
     }
   }  
 }
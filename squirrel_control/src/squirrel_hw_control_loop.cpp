@@ -4,6 +4,14 @@
 
 #include "squirrel_control/squirrel_hw_control_loop.h"
 #include <rosparam_shortcuts/rosparam_shortcuts.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <string.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 
 namespace squirrel_control {
 
@@ -11,6 +19,8 @@ namespace squirrel_control {
                                                  boost::shared_ptr <squirrel_control::SquirrelHWInterface> hardware_interface)
         : nh_(nh)
           , hardware_interface_(hardware_interface)
+          , running_(false)
+          , worst_cycle_since_report_(0)
     {
         std::cout << "Intializing loop..." << std::endl;
         // Create the controller manager
@@ -22,28 +32,178 @@ namespace squirrel_control {
         error += !rosparam_shortcuts::get(name_, rpsnh, "loop_hz", loop_hz_);
         error += !rosparam_shortcuts::get(name_, rpsnh, "cycle_time_error_threshold", cycle_time_error_threshold_);
         rosparam_shortcuts::shutdownIfError(name_, error);
+        rpsnh.param("realtime", realtime_, false);
+        rpsnh.param("realtime_priority", realtime_priority_, 80);
+        rpsnh.param("cpu_affinity", cpu_affinity_, -1);
+        rpsnh.param("lock_memory", lock_memory_, true);
+        double diagnostics_rate;
+        rpsnh.param("diagnostics_rate", diagnostics_rate, 1.0);
+        rpsnh.param("timing_dump_file", timing_dump_file_, std::string(""));
+        desired_update_freq_ = ros::Duration(1 / loop_hz_);
 
         // Get current time for use with first update
         clock_gettime(CLOCK_MONOTONIC, &last_time_);
 
-        // Start timer
-        ros::Duration desired_update_freq = ros::Duration(1 / loop_hz_);
-        non_realtime_loop_ = nh_.createTimer(desired_update_freq, &SquirrelHWControlLoop::update, this);
+        if (realtime_) {
+            // page faults in the control thread would defeat the scheduling class
+            if (lock_memory_ && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+                ROS_WARN_STREAM_NAMED(name_, "mlockall failed: " << strerror(errno));
+            running_ = true;
+            realtime_loop_ = std::thread(&SquirrelHWControlLoop::realtimeLoop, this);
+        } else {
+            // Start timer
+            non_realtime_loop_ = nh_.createTimer(desired_update_freq_, &SquirrelHWControlLoop::update, this);
+        }
+
+        if (diagnostics_rate > 0.0) {
+            diagnostics_pub_ = nh_.advertise<diagnostic_msgs::DiagnosticArray>("/diagnostics", 1);
+            diagnostics_timer_ = nh_.createTimer(ros::Duration(1.0 / diagnostics_rate), &SquirrelHWControlLoop::publishDiagnostics, this);
+        }
 
 	    std::cout << "Looping..." << std::endl;
     }
 
 
     SquirrelHWControlLoop::~SquirrelHWControlLoop() {
+        running_ = false;
+        if (realtime_loop_.joinable())
+            realtime_loop_.join();
+
+        if (!timing_dump_file_.empty()) {
+            std::ofstream file(timing_dump_file_.c_str());
+            if (file.is_open()) {
+                std::vector<diagnostic_msgs::KeyValue> values = timingValues();
+                for (std::size_t i = 0; i < values.size(); ++i)
+                    file << values[i].key << ": " << values[i].value << std::endl;
+            } else {
+                std::cout << "Unable to write timing to " << timing_dump_file_ << std::endl;
+            }
+        }
+    }
+
+
+    static void addTiming(std::vector<diagnostic_msgs::KeyValue> &values, const std::string &name, const LatencyHistogram &timing) {
+        const char *labels[] = {" p50 [us]", " p99 [us]", " max [us]"};
+        uint64_t nanoseconds[] = {timing.percentile(50.0), timing.percentile(99.0), timing.max()};
+        for (int i = 0; i < 3; ++i) {
+            diagnostic_msgs::KeyValue value;
+            value.key = name + labels[i];
+            std::ostringstream ss;
+            ss << std::fixed << std::setprecision(1) << nanoseconds[i] / 1000.0;
+            value.value = ss.str();
+            values.push_back(value);
+        }
+    }
+
+
+    std::vector<diagnostic_msgs::KeyValue> SquirrelHWControlLoop::timingValues() {
+        std::vector<diagnostic_msgs::KeyValue> values;
+        diagnostic_msgs::KeyValue cycles;
+        cycles.key = "cycles";
+        std::ostringstream ss;
+        ss << cycle_timing_.count();
+        cycles.value = ss.str();
+        values.push_back(cycles);
+        addTiming(values, "cycle", cycle_timing_);
+        addTiming(values, "read", read_timing_);
+        addTiming(values, "update", update_timing_);
+        addTiming(values, "write", write_timing_);
+        addTiming(values, "bus read", hardware_interface_->getMotorInterface()->busReadTiming());
+        addTiming(values, "bus write", hardware_interface_->getMotorInterface()->busWriteTiming());
+        return values;
+    }
+
+
+    void SquirrelHWControlLoop::publishDiagnostics(const ros::TimerEvent &e) {
+        diagnostic_msgs::DiagnosticArray diagnostics;
+        diagnostics.header.stamp = ros::Time::now();
+        diagnostic_msgs::DiagnosticStatus status;
+        status.name = name_ + ": timing";
+        status.hardware_id = "squirrel_arm";
+        status.values = timingValues();
+        // only the cycles since the last message count, so that the status recovers after a single overrun
+        uint64_t worst = worst_cycle_since_report_.exchange(0, std::memory_order_relaxed);
+        diagnostic_msgs::KeyValue worst_value;
+        worst_value.key = "cycle max since last report [us]";
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1) << worst / 1000.0;
+        worst_value.value = ss.str();
+        status.values.push_back(worst_value);
+        if (worst > 0 && worst / BILLION - desired_update_freq_.toSec() > cycle_time_error_threshold_) {
+            status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+            status.message = "Cycle time exceeded error threshold";
+        } else {
+            status.level = diagnostic_msgs::DiagnosticStatus::OK;
+            status.message = "OK";
+        }
+        diagnostics.status.push_back(status);
+        diagnostics_pub_.publish(diagnostics);
+    }
+
 
+    void SquirrelHWControlLoop::configureRealtimeThread() {
+        struct sched_param param;
+        param.sched_priority = realtime_priority_;
+        int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (result != 0)
+            ROS_WARN_STREAM_NAMED(name_, "Cannot run control thread with SCHED_FIFO priority " << realtime_priority_
+                    << ": " << strerror(result) << " (check rtprio in /etc/security/limits.conf)");
+
+        if (cpu_affinity_ >= 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu_affinity_, &cpus);
+            result = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            if (result != 0)
+                ROS_WARN_STREAM_NAMED(name_, "Cannot pin control thread to CPU " << cpu_affinity_ << ": " << strerror(result));
+        }
+    }
+
+
+    void SquirrelHWControlLoop::realtimeLoop() {
+        configureRealtimeThread();
+
+        const long period_ns = static_cast<long>(BILLION / loop_hz_);
+        struct timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+
+        while (running_ && ros::ok()) {
+            update();
+
+            // absolute deadlines do not accumulate the time spent in update()
+            next.tv_nsec += period_ns;
+            while (next.tv_nsec >= BILLION) {
+                next.tv_nsec -= BILLION;
+                next.tv_sec++;
+            }
+
+            // after an overrun start over from now instead of running the missed cycles back to back
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (now.tv_sec > next.tv_sec || (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec)) {
+                next = now;
+                continue;
+            }
+
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {}
+        }
     }
 
 
     void SquirrelHWControlLoop::update(const ros::TimerEvent &e) {
+        update();
+    }
+
+
+    void SquirrelHWControlLoop::update() {
         // Get change in time
         clock_gettime(CLOCK_MONOTONIC, &current_time_);
         elapsed_time_ =
                 ros::Duration(current_time_.tv_sec - last_time_.tv_sec + (current_time_.tv_nsec - last_time_.tv_nsec) / BILLION);
+        uint64_t cycle_ns = LatencyHistogram::elapsedNanoseconds(last_time_, current_time_);
+        cycle_timing_.record(cycle_ns);
+        if (cycle_ns > worst_cycle_since_report_.load(std::memory_order_relaxed))
+            worst_cycle_since_report_.store(cycle_ns, std::memory_order_relaxed);
         last_time_ = current_time_;
         ROS_DEBUG_STREAM_THROTTLE_NAMED(1, "generic_hw_main","Sampled update loop with elapsed time " << elapsed_time_.toSec());
 
@@ -57,13 +217,21 @@ namespace squirrel_control {
         }
 
         // Input
+        struct timespec phase_start = current_time_;
         hardware_interface_->read(elapsed_time_);
+        struct timespec phase_end = LatencyHistogram::now();
+        read_timing_.record(LatencyHistogram::elapsedNanoseconds(phase_start, phase_end));
 
         // Control
+        phase_start = phase_end;
         controller_manager_->update(ros::Time::now(), elapsed_time_, hardware_interface_->getResetSignal());
+        phase_end = LatencyHistogram::now();
+        update_timing_.record(LatencyHistogram::elapsedNanoseconds(phase_start, phase_end));
 
         // Output
+        phase_start = phase_end;
         hardware_interface_->write(elapsed_time_);
+        write_timing_.recordSince(phase_start);
     }
 
 }
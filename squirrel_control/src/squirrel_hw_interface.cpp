@@ -32,16 +32,45 @@ namespace squirrel_control {
 		rosparam_shortcuts::shutdownIfError(name_, error);
 		error += !rosparam_shortcuts::get(name_, rpnh, "ignore_base", ignore_base);
 		rosparam_shortcuts::shutdownIfError(name_, error);
+		// base joints in x, y, yaw order, arm joints in the order of motor_ids
+		rpnh.param("base_joints", base_joint_names_, std::vector<std::string>{"base_jointx", "base_jointy", "base_jointz"});
+		rpnh.param("arm_joints", arm_joint_names_, std::vector<std::string>{"arm_joint1", "arm_joint2", "arm_joint3", "arm_joint4", "arm_joint5"});
+		rpnh.param("motor_ids", motor_ids_, std::vector<int>{1, 2, 3, 4, 5});
+		rpnh.param("device_joints", device_joint_names_, std::vector<std::string>());
+		rpnh.param("device_ids", device_ids_, std::vector<int>());
+		throw_control_error(base_joint_names_.size() != 3, "Expected 3 base joints, got " << base_joint_names_.size());
+		throw_control_error(arm_joint_names_.size() != motor_ids_.size(), "Got " << arm_joint_names_.size() << " arm joints for " << motor_ids_.size() << " motors");
+		throw_control_error(device_joint_names_.size() != device_ids_.size(), "Got " << device_joint_names_.size() << " device joints for " << device_ids_.size() << " devices");
 		motor_interface_ = new motor_control::MotorUtilities();
+		for (std::size_t i = 0; i < device_ids_.size(); ++i)
+			motor_interface_->addDevice(device_joint_names_[i], device_ids_[i]);
+		bool sync_read;
+		rpnh.param("sync_read", sync_read, true);
+		motor_interface_->setSyncRead(sync_read);
+		bool sync_write;
+		rpnh.param("sync_write", sync_write, true);
+		motor_interface_->setSyncWrite(sync_write);
+		bool indirect_read;
+		rpnh.param("indirect_read", indirect_read, false);
+		motor_interface_->setIndirectRead(indirect_read);
+		bool pipelined_read;
+		rpnh.param("pipelined_read", pipelined_read, false);
+		motor_interface_->setPipelinedRead(pipelined_read);
+		bool blocking_read;
+		rpnh.param("blocking_read", blocking_read, true);
+		motor_interface_->setBlockingRead(blocking_read);
+		bool low_latency;
+		rpnh.param("low_latency", low_latency, true);
+		motor_interface_->setLowLatency(low_latency);
+		rpnh.param("base_feed_forward", base_feed_forward_, true);
 		base_interface_ = rpnh.advertise<geometry_msgs::Twist>("/cmd_rotatory", 1);
 		base_state_ = rpnh.subscribe("/odom", 10, &SquirrelHWInterface::odomCallback, this);
 		reset_signal_ = true;
-        trajectory_command_sub_ = rpnh.subscribe("/arm_controller/joint_trajectory_controller/command", 10, &SquirrelHWInterface::commandCallback, this);
         ignore_base = true;
-        state_pub_ = rpnh.advertise<sensor_msgs::JointState>("/arm_controller/joint_states", 1);
-        control_pub_ = rpnh.advertise<control_msgs::JointTrajectoryControllerState>("/arm_controller/joint_trajectory_controller/state", 1);
+        state_pub_.reset(new realtime_tools::RealtimePublisher<sensor_msgs::JointState>(rpnh, "/arm_controller/joint_states", 1));
+        control_pub_.reset(new realtime_tools::RealtimePublisher<control_msgs::JointTrajectoryControllerState>(rpnh, "/arm_controller/joint_trajectory_controller/state", 1));
+        rpnh.param("state_publish_rate", state_publish_rate_, 100.0);
         first_broadcast_ = true;
-        last_trajectory_goal_.resize(joint_names_.size());
 	}
 
 
@@ -53,6 +82,14 @@ namespace squirrel_control {
 	void SquirrelHWInterface::init() {
 		base_cmds_ = std::vector<double>(3);
         num_joints_ = joint_names_.size();
+		buildJointMapping();
+		initStatePublishers();
+
+		command_goal_.positions.assign(num_joints_, 0.0);
+		trajectory_goal_ = command_goal_;
+		goal_buffer_.reset(command_goal_);
+		// subscribe only once the goal storage and the joint index exist
+		trajectory_command_sub_ = nh_.subscribe("/arm_controller/joint_trajectory_controller/command", 10, &SquirrelHWInterface::commandCallback, this);
 
 		// Status
 		joint_position_.resize(num_joints_, 0.0);
@@ -70,6 +107,11 @@ namespace squirrel_control {
 		joint_velocity_limits_.resize(num_joints_, 0.0);
 		joint_effort_limits_.resize(num_joints_, 0.0);
 
+		// Arm
+		arm_values_.resize(arm_joint_names_.size(), 0.0);
+		arm_positions_.resize(arm_joint_names_.size(), 0.0);
+		arm_commands_.resize(arm_joint_names_.size(), 0.0);
+
 		// Initialize interfaces for each joint
 		for (std::size_t joint_id = 0; joint_id < num_joints_; ++joint_id)
 		{
@@ -102,13 +144,108 @@ namespace squirrel_control {
 		registerInterface(&velocity_joint_interface_);  // From RobotHW base class.
 		registerInterface(&effort_joint_interface_);    // From RobotHW base class.
 
-		motor_interface_->initMotors(motor_port_, {1,2,3,4,5});
+		motor_interface_->initMotors(motor_port_, motor_ids_);
+		throw_control_error(motor_interface_->getMotors().size() != motor_ids_.size(),
+				"Found " << motor_interface_->getMotors().size() << " of " << motor_ids_.size() << " arm motors");
+		throw_control_error(motor_interface_->getDevices().size() != device_ids_.size(),
+				"Found " << motor_interface_->getDevices().size() << " of " << device_ids_.size() << " devices");
 		motor_interface_->startMotors();
 
 		ROS_INFO_STREAM_NAMED(name_, "SquirrelHWInterface ready.");
 	}
 
 
+	void SquirrelHWInterface::buildJointMapping() {
+		joint_mapping_.resize(num_joints_);
+		joint_index_.clear();
+		for (std::size_t i = 0; i < num_joints_; ++i) {
+			joint_index_[joint_names_[i]] = i;
+			JointMapping &joint = joint_mapping_[i];
+			joint.device = UNMAPPED_DEVICE;
+			joint.channel = 0;
+			std::vector<std::string>::const_iterator it = std::find(base_joint_names_.begin(), base_joint_names_.end(), joint_names_[i]);
+			if (it != base_joint_names_.end()) {
+				joint.device = BASE_DEVICE;
+				joint.channel = it - base_joint_names_.begin();
+				continue;
+			}
+			it = std::find(arm_joint_names_.begin(), arm_joint_names_.end(), joint_names_[i]);
+			if (it != arm_joint_names_.end()) {
+				joint.device = ARM_DEVICE;
+				joint.channel = it - arm_joint_names_.begin();
+				continue;
+			}
+			it = std::find(device_joint_names_.begin(), device_joint_names_.end(), joint_names_[i]);
+			if (it != device_joint_names_.end()) {
+				joint.device = SERVO_DEVICE;
+				joint.channel = it - device_joint_names_.begin();
+				continue;
+			}
+			ROS_WARN_STREAM_NAMED(name_, "Joint " << joint_names_[i] << " is neither a base, an arm nor a device joint and will not be driven");
+		}
+	}
+
+
+	void SquirrelHWInterface::initStatePublishers() {
+		std::vector<std::string> names = arm_joint_names_;
+		names.insert(names.end(), base_joint_names_.begin(), base_joint_names_.end());
+		std::size_t num_broadcast = names.size();
+
+		state_pub_->lock();
+		state_pub_->msg_.name = names;
+		state_pub_->msg_.position.assign(num_broadcast, 0.0);
+		state_pub_->msg_.velocity.assign(num_broadcast, 0.0);
+		state_pub_->msg_.effort.assign(num_broadcast, 0.0);
+		state_pub_->unlock();
+
+		control_pub_->lock();
+		control_msgs::JointTrajectoryControllerState &control_state = control_pub_->msg_;
+		control_state.joint_names = names;
+		control_state.actual.positions.assign(num_broadcast, 0.0);
+		control_state.actual.velocities.assign(num_broadcast, 0.0);
+		control_state.actual.accelerations.assign(num_broadcast, 0.0);
+		control_state.actual.effort.assign(num_broadcast, 0.0);
+		control_state.desired = control_state.actual;
+		control_state.error = control_state.actual;
+		control_pub_->unlock();
+	}
+
+
+	bool SquirrelHWInterface::publishStates(const std::vector<double> &positions, bool force) {
+		ros::Time now = ros::Time::now();
+		if (!force && state_publish_rate_ > 0.0 && now < last_state_publish_time_ + ros::Duration(1.0 / state_publish_rate_))
+			return false;
+
+		// the messages were sized in init(), filling them only copies values
+		std::size_t num_arm = std::min(positions.size(), arm_joint_names_.size());
+		bool published = true;
+		if (state_pub_->trylock()) {
+			sensor_msgs::JointState &joint_state = state_pub_->msg_;
+			std::copy(positions.begin(), positions.begin() + num_arm, joint_state.position.begin());
+			std::copy(odom_.position, odom_.position + 3, joint_state.position.begin() + arm_joint_names_.size());
+			joint_state.header.stamp = now;
+			state_pub_->unlockAndPublish();
+		} else {
+			published = false;
+		}
+
+		if (control_pub_->trylock()) {
+			control_msgs::JointTrajectoryControllerState &control_state = control_pub_->msg_;
+			std::copy(positions.begin(), positions.begin() + num_arm, control_state.actual.positions.begin());
+			std::copy(odom_.position, odom_.position + 3, control_state.actual.positions.begin() + arm_joint_names_.size());
+			control_state.desired.positions = control_state.actual.positions;
+			control_state.header.stamp = now;
+			control_pub_->unlockAndPublish();
+		} else {
+			published = false;
+		}
+
+		if (published)
+			last_state_publish_time_ = now;
+		return published;
+	}
+
+
 	void SquirrelHWInterface::registerJointLimits(const hardware_interface::JointHandle &joint_handle_position,
 			const hardware_interface::JointHandle &joint_handle_velocity,
 			const hardware_interface::JointHandle &joint_handle_effort,
@@ -355,107 +492,62 @@ namespace squirrel_control {
 
 
 	void SquirrelHWInterface::read(ros::Duration &elapsed_time) {
-		odom_lock_.lock();
-        auto positions = motor_interface_->read();
-		switch(current_mode_) {
-			case control_modes::POSITION_MODE:
-				{
-					for(int i=0; i < joint_names_.size(); ++i)
-					{
-						if(joint_names_[i] == "base_jointx") {
-							joint_position_[i] = posBuffer_[0];
-						} else if (joint_names_[i] == "base_jointy") {
-							joint_position_[i] = posBuffer_[1];
-						} else if (joint_names_[i] == "base_jointz") {
-							joint_position_[i] = posBuffer_[2];
-						} else if (joint_names_[i] == "arm_joint1") {
-							joint_position_[i] = positions[0];
-						} else if (joint_names_[i] == "arm_joint2") {
-							joint_position_[i] = positions[1];
-						} else if (joint_names_[i] == "arm_joint3") {
-							joint_position_[i] = positions[2];
-						} else if (joint_names_[i] == "arm_joint4") {
-							joint_position_[i] = positions[3];
-						} else if (joint_names_[i] == "arm_joint5") {
-							joint_position_[i] = positions[4];
-						}
-					}
-				}
-				break;
-			case control_modes::VELOCITY_MODE:
-				{
-					throw_control_error(true, "VELOCITY_MODE not tested!");
-
-					joint_velocity_[0] = velBuffer_[0];
-					joint_velocity_[1] = velBuffer_[1];
-					joint_velocity_[2] = velBuffer_[2];
-					auto velocities = motor_interface_->read();
-					for (int i = 0; i < num_joints_-3; i++) {
-						joint_velocity_[i + 3] = velocities[i];
-					}
-				}
-				break;
-			case control_modes::TORQUE_MODE:
-				{
-					throw_control_error(true, "TORQUE_MODE not tested!");
-
-					joint_effort_[0] = velBuffer_[0];
-					joint_effort_[1] = velBuffer_[1];
-					joint_effort_[2] = velBuffer_[2];
-					auto torques = motor_interface_->read();
-					for (int i = 0; i < num_joints_-3; i++) {
-						joint_effort_[i + 3] = torques[i];
+		// Odometry is sampled once per cycle, the callback never blocks the control loop
+		odom_buffer_.read(odom_);
+		// A new trajectory command makes the base follow again
+		if (goal_buffer_.read(trajectory_goal_)) {
+			ignore_base = false;
+			reset_signal_ = false;
+		}
+		// The batched state read returns position, velocity and effort of every motor in all modes
+		const std::vector<motor_control::MotorState> *states = NULL;
+		if (motor_interface_->syncReadEnabled())
+			states = &motor_interface_->readStates();
+		else
+			// without a common state layout only the quantity of the current mode is read
+			motor_interface_->read(arm_values_);
+
+		for (std::size_t i = 0; i < num_joints_; ++i) {
+			const JointMapping &joint = joint_mapping_[i];
+			if (joint.device == BASE_DEVICE) {
+				joint_position_[i] = odom_.position[joint.channel];
+				joint_velocity_[i] = odom_.velocity[joint.channel];
+			} else if (joint.device == ARM_DEVICE) {
+				if (states) {
+					joint_position_[i] = (*states)[joint.channel].position;
+					joint_velocity_[i] = (*states)[joint.channel].velocity;
+					joint_effort_[i] = (*states)[joint.channel].effort;
+				} else {
+					switch(current_mode_) {
+						case control_modes::POSITION_MODE:
+							joint_position_[i] = arm_values_[joint.channel];
+							break;
+						case control_modes::VELOCITY_MODE:
+							joint_velocity_[i] = arm_values_[joint.channel];
+							break;
+						case control_modes::TORQUE_MODE:
+							joint_effort_[i] = arm_values_[joint.channel];
+							break;
+						default:
+							throw_control_error(true, "Unknown mode: " << current_mode_);
 					}
 				}
-				break;
-			default:
-				odom_lock_.unlock();
-				throw_control_error(true, "Unknown mode: " << current_mode_);
+				arm_positions_[joint.channel] = joint_position_[i];
+			} else if (joint.device == SERVO_DEVICE) {
+				// the devices are read together with the arm
+				const motor_control::MotorState &state = motor_interface_->deviceStates()[joint.channel];
+				joint_position_[i] = state.position;
+				joint_velocity_[i] = state.velocity;
+				joint_effort_[i] = state.effort;
+			}
 		}
-		odom_lock_.unlock();
         if((ignore_base && reset_signal_) || !first_broadcast_)
         {
-            if(!first_broadcast_)
+            // the initial broadcast is retried every cycle until it got through
+            if(publishStates(arm_positions_, !first_broadcast_) && !first_broadcast_) {
                 ROS_INFO("Broadcasting states on initialization");
-            sensor_msgs::JointState current_joint_state;
-            current_joint_state.name.resize(8);
-            current_joint_state.position.resize(8);
-            current_joint_state.velocity = std::vector<double>(8,0.0);
-            current_joint_state.effort = std::vector<double>(8,0.0);
-            current_joint_state.name[0] = "arm_joint1";
-            current_joint_state.position[0] = positions[0];
-            current_joint_state.name[1] = "arm_joint2";
-            current_joint_state.position[1] = positions[1];
-            current_joint_state.name[2] = "arm_joint3";
-            current_joint_state.position[2] = positions[2];
-            current_joint_state.name[3] = "arm_joint4";
-            current_joint_state.position[3] = positions[3];
-            current_joint_state.name[4] = "arm_joint5";
-            current_joint_state.position[4] = positions[4];
-            current_joint_state.name[5] = "base_jointx";
-            current_joint_state.position[5] = posBuffer_[0];
-            current_joint_state.name[6] = "base_jointy";
-            current_joint_state.position[6] = posBuffer_[1];
-            current_joint_state.name[7] = "base_jointz";
-            current_joint_state.position[7] = posBuffer_[2];
-            current_joint_state.header.stamp = ros::Time::now();
-            state_pub_.publish(current_joint_state);
-            ros::spinOnce();
-            control_msgs::JointTrajectoryControllerState control_state;
-            control_state.joint_names = current_joint_state.name;
-            control_state.actual.positions = current_joint_state.position;
-            control_state.actual.velocities = std::vector<double>(8,0.0);
-            control_state.actual.accelerations = std::vector<double>(8,0.0);
-            control_state.actual.effort = std::vector<double>(8,0.0);
-            control_state.desired = control_state.actual;
-            control_state.error.positions = std::vector<double>(8,0.0);
-            control_state.error.velocities = std::vector<double>(8,0.0);
-            control_state.error.accelerations = std::vector<double>(8,0.0);
-            control_state.error.effort = std::vector<double>(8,0.0);
-            control_state.header.stamp = ros::Time::now();
-            control_pub_.publish(control_state);
-            ros::spinOnce();
-            first_broadcast_ = true;         
+                first_broadcast_ = true;
+            }
         }
 	}
 
@@ -475,88 +567,81 @@ namespace squirrel_control {
 	void SquirrelHWInterface::write(ros::Duration &elapsed_time) {
 		//This is for that the robot keeps its initial pose and does not move back to 0 (default initialization of C++ for class members)
 		if (hold) {
-			auto base_state = base_controller_.getCurrentState();
-			last_base_cmd_.clear();
+			BasePose base_state = base_controller_.getCurrentPose();
 
 
 			joint_position_command_ = joint_position_;
 			joint_effort_command_ = joint_effort_;
 			joint_velocity_command_ = joint_velocity_;
 
-			for(int i=0; i < 3; i++) {
-				base_cmds_[i] = base_state[i];
-				last_base_cmd_.push_back(base_state[i]);
-			}
+			base_cmds_[0] = base_state.x;
+			base_cmds_[1] = base_state.y;
+			base_cmds_[2] = base_state.theta;
+			last_base_cmd_ = base_cmds_;
 
-			for(int i=0; i<joint_names_.size(); ++i){
-				if(joint_names_[i] == "base_jointx") {
-					joint_effort_command_[i] = 0.0;
-					joint_velocity_command_[i] = 0.0;
-				} else if (joint_names_[i] == "base_jointy") {
-					joint_effort_command_[i] = 0.0;
-					joint_velocity_command_[i] = 0.0;
-				} else if (joint_names_[i] == "base_jointz") {
+			for(std::size_t i=0; i<num_joints_; ++i){
+				if(joint_mapping_[i].device == BASE_DEVICE) {
 					joint_effort_command_[i] = 0.0;
 					joint_velocity_command_[i] = 0.0;
-				}				
-			}     
+				}
+			}
 			hold = false;
             first_broadcast_ = false;
 		}
 
 		enforceLimits(elapsed_time);    
-		std::vector<double> cmds(5);
+		double base_twist[3] = {0.0, 0.0, 0.0};
 		geometry_msgs::Twist twist;
         bool prev_ignore_base = ignore_base;
 		switch(current_mode_){
 			case control_modes::POSITION_MODE:
-				for(int i=0; i<joint_names_.size(); ++i) {
-					if(joint_names_[i] == "base_jointx") {
-						base_cmds_[0] = joint_position_command_[i];
-					} else if (joint_names_[i] == "base_jointy") {
-						base_cmds_[1] = joint_position_command_[i];
-					} else if (joint_names_[i] == "base_jointz") {
-						base_cmds_[2] = joint_position_command_[i];
-					} else if (joint_names_[i] == "arm_joint1") {
-						cmds[0] = joint_position_command_[i];
-					} else if (joint_names_[i] == "arm_joint2") {
-						cmds[1] = joint_position_command_[i];
-					} else if (joint_names_[i] == "arm_joint3") {
-						cmds[2] = joint_position_command_[i];
-					} else if (joint_names_[i] == "arm_joint4") {
-						cmds[3] = joint_position_command_[i];
-					} else if (joint_names_[i] == "arm_joint5") {
-						cmds[4] = joint_position_command_[i];
+				for(std::size_t i=0; i<num_joints_; ++i) {
+					const JointMapping &joint = joint_mapping_[i];
+					if(joint.device == BASE_DEVICE) {
+						base_cmds_[joint.channel] = joint_position_command_[i];
+					} else if (joint.device == ARM_DEVICE) {
+						arm_commands_[joint.channel] = joint_position_command_[i];
+					} else if (joint.device == SERVO_DEVICE) {
+						// devices are only position controlled, in the other modes they keep their last goal
+						motor_interface_->setDeviceGoal(joint.channel, joint_position_command_[i]);
 					}
 				}
+				// the trajectory controller only hands over positions, the base follows their difference quotient as
+				// velocity feed forward instead of lagging behind them
+				for(std::size_t axis = 0; axis < 3; ++axis) {
+					double step = base_cmds_[axis] - last_base_cmd_.at(axis);
+					if (axis == 2)
+						step = atan2(sin(step), cos(step));
+					base_setpoint_.position[axis] = base_cmds_[axis];
+					base_setpoint_.velocity[axis] = base_feed_forward_ && elapsed_time.toSec() > 0.0 ? step / elapsed_time.toSec() : 0.0;
+					base_setpoint_.acceleration[axis] = 0.0;
+				}
 				//ignore_base = allClose(base_cmds_, last_base_cmd_);
 				last_base_cmd_.clear();
 				last_base_cmd_ = base_cmds_;
 				break;
 			case control_modes::VELOCITY_MODE:
-				throw_control_error(true, "VELOCITY_MODE not tested!");
-
-				twist.linear.x = joint_velocity_command_[0];
-				twist.linear.y = joint_velocity_command_[1];
+				for(std::size_t i=0; i<num_joints_; ++i) {
+					const JointMapping &joint = joint_mapping_[i];
+					if(joint.device == BASE_DEVICE) {
+						base_twist[joint.channel] = joint_velocity_command_[i];
+					} else if (joint.device == ARM_DEVICE) {
+						arm_commands_[joint.channel] = joint_velocity_command_[i];
+					}
+				}
+				twist.linear.x = base_twist[0];
+				twist.linear.y = base_twist[1];
 				twist.linear.z = 0.0;
 				twist.angular.x = 0.0;
 				twist.angular.y = 0.0;
-				twist.angular.z = joint_velocity_command_[2];
-				for(int i = 0; i < num_joints_-3; i++){
-					cmds[i] = joint_velocity_command_[i+3];
-				}
+				twist.angular.z = base_twist[2];
 				break;
 			case control_modes::TORQUE_MODE:
-				throw_control_error(true, "TORQUE_MODE not tested!");
-
-				twist.linear.x = joint_effort_command_[0];
-				twist.linear.y = joint_effort_command_[1];
-				twist.linear.z = 0.0;
-				twist.angular.x = 0.0;
-				twist.angular.y = 0.0;
-				twist.angular.z = joint_effort_command_[2];
-				for(int i = 0; i < num_joints_-3; i++){
-					cmds[i] = joint_effort_command_[i+3];
+				// the base takes no effort commands, it is kept at standstill while the arm is torque controlled
+				for(std::size_t i=0; i<num_joints_; ++i) {
+					const JointMapping &joint = joint_mapping_[i];
+					if (joint.device == ARM_DEVICE)
+						arm_commands_[joint.channel] = joint_effort_command_[i];
 				}
 				break;
 			default:
@@ -564,17 +649,16 @@ namespace squirrel_control {
 		}
 
 		try {
-            motor_interface_->write(cmds);
+            motor_interface_->write(arm_commands_);
 			if(!ignore_base) {
 				if (current_mode_ == control_modes::POSITION_MODE) {
-                    base_controller_.moveBase(base_cmds_.at(0), base_cmds_.at(1), base_cmds_.at(2));
+                    base_controller_.moveBase(base_setpoint_);
 				} else {
-					throw_control_error(true, "Not tested!");
-					base_interface_.publish(twist);			
+					base_interface_.publish(twist);
 				}
                     
-                if(allClose(joint_position_, last_trajectory_goal_, 1e-2) &&
-                   (ros::Time::now()-last_trajectory_time_).toSec() > 0.2) {
+                if(allClose(joint_position_, trajectory_goal_.positions, 1e-2) &&
+                   (ros::Time::now()-trajectory_goal_.stamp).toSec() > 0.2) {
                     ROS_INFO("Command has finished");
                     ignore_base = true;
                     reset_signal_ = true;
@@ -605,41 +689,42 @@ namespace squirrel_control {
 
 
 	void SquirrelHWInterface::odomCallback(const nav_msgs::OdometryConstPtr &msg) {
-		odom_lock_.lock();
-		posBuffer_[0] = msg->pose.pose.position.x;
-		posBuffer_[1] = msg->pose.pose.position.y;
-		posBuffer_[2] = tf::getYaw(msg->pose.pose.orientation);
-        velBuffer_[0] = msg->twist.twist.angular.x;
-		velBuffer_[1] = msg->twist.twist.angular.y;
-        velBuffer_[2] = msg->twist.twist.angular.z;	
-		odom_lock_.unlock();
+		BaseOdom odom;
+		odom.position[0] = msg->pose.pose.position.x;
+		odom.position[1] = msg->pose.pose.position.y;
+		odom.position[2] = tf::getYaw(msg->pose.pose.orientation);
+		odom.velocity[0] = msg->twist.twist.linear.x;
+		odom.velocity[1] = msg->twist.twist.linear.y;
+		odom.velocity[2] = msg->twist.twist.angular.z;
+		odom_buffer_.write(odom);
 	}
 
     bool SquirrelHWInterface::getResetSignal() {
         return reset_signal_;
     }
 
+    motor_control::MotorUtilities* SquirrelHWInterface::getMotorInterface() {
+        return motor_interface_;
+    }
+
     void SquirrelHWInterface::commandCallback(const trajectory_msgs::JointTrajectoryConstPtr &msg)
     {
         ROS_INFO("Received a new command");
-        ignore_base = false;
-        reset_signal_ = false;
-        
-        // Store the last joint configuration from the command
-        last_trajectory_time_ = ros::Time::now();
-        int trajectory_length = msg->points.size();
-        last_trajectory_goal_.resize(joint_names_.size());
-        for(size_t i = 0; i < msg->points[trajectory_length-1].positions.size(); ++i)
+        if(msg->points.empty())
+            return;
+
+        // Store the last joint configuration from the command, joints it does not name keep their previous goal.
+        // Goals are stored in the order of joint_names_, so that they compare against joint_position_
+        const trajectory_msgs::JointTrajectoryPoint &last_point = msg->points.back();
+        command_goal_.stamp = ros::Time::now();
+        for(size_t i = 0; i < last_point.positions.size() && i < msg->joint_names.size(); ++i)
         {
-            if(msg->joint_names[i].compare("base_jointx") == 0) last_trajectory_goal_[0] = msg->points[trajectory_length-1].positions[i];
-            else if(msg->joint_names[i].compare("base_jointy") == 0) last_trajectory_goal_[1] = msg->points[trajectory_length-1].positions[i];
-            else if(msg->joint_names[i].compare("base_jointz") == 0) last_trajectory_goal_[2] = msg->points[trajectory_length-1].positions[i];
-            else if(msg->joint_names[i].compare("arm_joint1") == 0) last_trajectory_goal_[3] = msg->points[trajectory_length-1].positions[i];
-            else if(msg->joint_names[i].compare("arm_joint2") == 0) last_trajectory_goal_[4] = msg->points[trajectory_length-1].positions[i];
-            else if(msg->joint_names[i].compare("arm_joint3") == 0) last_trajectory_goal_[5] = msg->points[trajectory_length-1].positions[i];
-            else if(msg->joint_names[i].compare("arm_joint4") == 0) last_trajectory_goal_[6] = msg->points[trajectory_length-1].positions[i];
-            else if(msg->joint_names[i].compare("arm_joint5") == 0) last_trajectory_goal_[7] = msg->points[trajectory_length-1].positions[i]; 
+            std::map<std::string, std::size_t>::const_iterator joint = joint_index_.find(msg->joint_names[i]);
+            if(joint != joint_index_.end())
+                command_goal_.positions[joint->second] = last_point.positions[i];
         }
+        // the control loop picks the goal up at its next read()
+        goal_buffer_.write(command_goal_);
     }
 }
 
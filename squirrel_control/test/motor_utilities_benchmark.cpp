@@ -0,0 +1,159 @@
+//
+// Throughput and loop timing of MotorUtilities on the simulated bus of PortHandlerSim, runs without hardware.
+//
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include <squirrel_control/motor_utilities.h>
+
+namespace {
+
+  // the arm as in config/controllers.yaml
+  const std::string ARM = "sim:1=46352,2=46352,3=38152,4=38152,5=38152";
+  // pan and tilt of the neck on the arm bus, their control table differs so the state read is a BULK_READ
+  const std::string ARM_AND_NECK = ARM + ",6=XM430_W350,7=XM430_W350";
+
+  const int CYCLES = 1000;
+  const double CONTROL_PERIOD_MS = 10.0;   // 100 Hz of the control loop
+
+  struct Options {
+    bool indirect_read;
+    bool pipelined_read;
+    bool with_neck;
+  };
+
+  struct Result {
+    squirrel_control::LatencyHistogram cycle_timing;
+    int failed_reads;
+    uint64_t single_reads;          // motors read one by one because their status packet of the batched read was lost
+    double max_position_error;      // between goal and position read back, the simulated motors reach a goal at once
+  };
+
+  double ms(uint64_t nanoseconds) {
+    return nanoseconds / 1e6;
+  }
+
+  // runs CYCLES write() + readStates() cycles in position mode and reports their timing
+  void runCycles(const std::string &name, const std::string &port, const Options &options, Result &result) {
+    motor_control::MotorUtilities motors;
+    motors.setIndirectRead(options.indirect_read);
+    if (options.with_neck) {
+      motors.addDevice("neck_pan", 6);
+      motors.addDevice("neck_tilt", 7);
+    }
+    ASSERT_TRUE(motors.initMotors(port, std::vector<int>()));
+    ASSERT_EQ(5u, motors.getMotors().size());
+    ASSERT_TRUE(motors.startMotors());
+    motors.setPipelinedRead(options.pipelined_read);
+
+    std::vector<double> commands(motors.getMotors().size());
+    result.failed_reads = 0;
+    result.max_position_error = 0.0;
+    for (int cycle = 0; cycle < CYCLES; ++cycle) {
+      for (std::size_t i = 0; i < commands.size(); ++i)
+        commands[i] = 0.1 * std::sin(0.1 * cycle + i);   // up to 0.01 rad per cycle, a stale state would show
+      if (options.with_neck)
+        motors.setDeviceGoal(0, 0.2 * std::sin(0.01 * cycle));
+
+      struct timespec start = squirrel_control::LatencyHistogram::now();
+      motors.write(commands);
+      const std::vector<motor_control::MotorState> &states = motors.readStates();
+      result.cycle_timing.recordSince(start);
+
+      for (std::size_t i = 0; i < states.size(); ++i) {
+        result.failed_reads += states[i].comm_result != COMM_SUCCESS;
+        result.max_position_error = std::max(result.max_position_error, std::fabs(states[i].position - commands[i]));
+      }
+    }
+
+    const squirrel_control::LatencyHistogram &read = motors.busReadTiming();
+    const squirrel_control::LatencyHistogram &write = motors.busWriteTiming();
+    // one batched read per cycle, every other read is the retry of a single motor
+    result.single_reads = read.count() - CYCLES;
+    const squirrel_control::LatencyHistogram &cycle_timing = result.cycle_timing;
+    std::cout << std::fixed << std::setprecision(3)
+              << "[ BENCH    ] " << std::left << std::setw(28) << name << std::right
+              << " cycles/s " << std::setw(8) << 1000.0 / ms(cycle_timing.percentile(50))
+              << "  cycle ms p50 " << ms(cycle_timing.percentile(50)) << " p99 " << ms(cycle_timing.percentile(99))
+              << " max " << ms(cycle_timing.max())
+              << "  read ms p50 " << ms(read.percentile(50)) << "  write ms p50 " << ms(write.percentile(50))
+              << "  failed reads " << result.failed_reads << "  single reads " << result.single_reads << std::endl;
+
+    motors.stopMotors();
+  }
+
+  void benchmark(const std::string &name, const std::string &port, const Options &options) {
+    Result result;
+    runCycles(name, port, options, result);
+    EXPECT_EQ(0, result.failed_reads);
+    EXPECT_EQ(0u, result.single_reads);
+    EXPECT_LT(result.max_position_error, 1e-3);
+    // the median cycle has to leave most of the control period to the controllers
+    EXPECT_LT(ms(result.cycle_timing.percentile(50)), CONTROL_PERIOD_MS / 2);
+  }
+
+}
+
+TEST(MotorUtilitiesBenchmark, syncRead) {
+  benchmark("sync read", ARM + ",latency=1", Options{false, false, false});
+}
+
+TEST(MotorUtilitiesBenchmark, indirectRead) {
+  benchmark("indirect read", ARM + ",latency=1", Options{true, false, false});
+}
+
+TEST(MotorUtilitiesBenchmark, pipelinedRead) {
+  benchmark("pipelined indirect read", ARM + ",latency=1", Options{true, true, false});
+}
+
+TEST(MotorUtilitiesBenchmark, bulkRead) {
+  benchmark("bulk read with neck", ARM_AND_NECK + ",latency=1", Options{false, false, true});
+}
+
+TEST(MotorUtilitiesBenchmark, lostStatusPackets) {
+  // motors that do not answer the batched read are re-read one by one, so every state is still read and current
+  Result result;
+  runCycles("1% dropped, 1% corrupted", ARM + ",latency=1,drop=0.01,corrupt=0.01,seed=1", Options{true, false, false},
+            result);
+  EXPECT_EQ(CYCLES, (int) result.cycle_timing.count());
+  EXPECT_EQ(0, result.failed_reads);
+  EXPECT_LT(result.max_position_error, 1e-3);
+  // 2% of the status packets are lost, a retry itself can be lost again
+  const double expected_single_reads = CYCLES * 5 * 0.02;
+  EXPECT_GT(result.single_reads, expected_single_reads / 2);
+  EXPECT_LT(result.single_reads, expected_single_reads * 2);
+}
+
+TEST(MotorUtilities, writeWithoutRead) {
+  // with pipelined read every write() leaves a state request on the bus; a second write() before readStates(),
+  // e.g. after an aborted read, has to collect it instead of finding the port busy
+  motor_control::MotorUtilities motors;
+  motors.setIndirectRead(true);
+  ASSERT_TRUE(motors.initMotors(ARM + ",latency=1", std::vector<int>()));
+  ASSERT_TRUE(motors.startMotors());
+  motors.setPipelinedRead(true);
+
+  std::vector<double> first(motors.getMotors().size(), 0.1);
+  std::vector<double> second(motors.getMotors().size(), -0.1);
+  for (int i = 0; i < 3; ++i) {
+    motors.write(first);
+    motors.write(second);
+    const std::vector<motor_control::MotorState> &states = motors.readStates();
+    ASSERT_EQ(second.size(), states.size());
+    for (std::size_t j = 0; j < states.size(); ++j) {
+      EXPECT_EQ(COMM_SUCCESS, states[j].comm_result);
+      EXPECT_NEAR(second[j], states[j].position, 1e-3);
+    }
+  }
+  motors.stopMotors();
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
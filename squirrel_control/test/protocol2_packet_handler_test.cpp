@@ -0,0 +1,87 @@
+//
+// Instructions of Protocol2PacketHandler whose parameters do not fit the packet buffer of the port, on the
+// simulated bus of PortHandlerSim.
+//
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include <dynamixel_sdk/PortHandler.h>
+#include <dynamixel_sdk/Protocol2PacketHandler.h>
+
+using namespace ROBOTIS;
+
+namespace {
+
+  // larger than PACKET_BUFFER_LEN, e.g. a group write over many motors with a long data block
+  const UINT16_T OVERSIZED = PACKET_BUFFER_LEN + 100;
+
+  class Protocol2PacketHandlerTest : public testing::Test {
+  protected:
+    PortHandler *port_;
+    Protocol2PacketHandler *packet_handler_;
+    std::vector<UINT8_T> param_;
+
+    virtual void SetUp() {
+      port_ = PortHandler::GetPortHandler("sim:1=46352");
+      ASSERT_TRUE(port_->OpenPort());
+      packet_handler_ = Protocol2PacketHandler::GetInstance();
+      param_.assign(OVERSIZED, 0x5A);
+      // rx_packet follows tx_packet, an overrun of the tx buffer would show up here
+      memset(port_->rx_packet, 0xA5, PACKET_BUFFER_LEN);
+    }
+
+    virtual void TearDown() {
+      port_->ClosePort();
+      delete port_;
+    }
+
+    void expectPortUsable() {
+      EXPECT_FALSE(port_->is_using);
+      for (int i = 0; i < PACKET_BUFFER_LEN; ++i)
+        ASSERT_EQ(0xA5, port_->rx_packet[i]) << "tx_packet overran into rx_packet at " << i;
+      UINT8_T error = 0;
+      EXPECT_EQ(COMM_SUCCESS, packet_handler_->Ping(port_, 1, &error));
+      memset(port_->rx_packet, 0xA5, PACKET_BUFFER_LEN);
+    }
+  };
+
+}
+
+TEST_F(Protocol2PacketHandlerTest, oversizedWrite) {
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->WriteTxOnly(port_, 1, 0, OVERSIZED, &param_[0]));
+  expectPortUsable();
+  UINT8_T error = 0;
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->WriteTxRx(port_, 1, 0, OVERSIZED, &param_[0], &error));
+  expectPortUsable();
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->RegWriteTxOnly(port_, 1, 0, OVERSIZED, &param_[0]));
+  expectPortUsable();
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->RegWriteTxRx(port_, 1, 0, OVERSIZED, &param_[0], &error));
+  expectPortUsable();
+}
+
+TEST_F(Protocol2PacketHandlerTest, oversizedGroupInstructions) {
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->SyncReadTx(port_, 0, 4, &param_[0], OVERSIZED));
+  expectPortUsable();
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->SyncWriteTxOnly(port_, 0, 4, &param_[0], OVERSIZED));
+  expectPortUsable();
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->BulkReadTx(port_, &param_[0], OVERSIZED));
+  expectPortUsable();
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->BulkWriteTxOnly(port_, &param_[0], OVERSIZED));
+  expectPortUsable();
+}
+
+TEST_F(Protocol2PacketHandlerTest, largestPacketFits) {
+  // the whole buffer, header and CRC included, is usable; motor 9 is not on the bus so nothing is written
+  UINT16_T length = PACKET_BUFFER_LEN - 8 - 2 - 2;   // 8: header up to the instruction, 2: address, 2: CRC16
+  EXPECT_EQ(COMM_SUCCESS, packet_handler_->WriteTxOnly(port_, 9, 0, length, &param_[0]));
+  EXPECT_EQ(COMM_TX_ERROR, packet_handler_->WriteTxOnly(port_, 9, 0, length + 1, &param_[0]));
+  expectPortUsable();
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
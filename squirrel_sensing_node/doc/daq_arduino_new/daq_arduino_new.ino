@@ -1,4 +1,10 @@
+//tactile and proximity sensing of the hand for the sensing node, see launch/startup.launch
+//as shipped it runs at 9600 baud and answers requests like the older sketches, which matches the defaults of the
+//node (tactile_streaming false, tactile_baudrate 9600). To stream binary frames set BAUD_RATE to 115200 or faster
+//and start the node with tactile_streaming:=true tactile_baudrate:=<the same rate>
+
 const int g=103;  //ascii code for 'g', ros sends this automatically
+const int s=115;  //ascii code for 's', ros sends this to start streaming
 const int c=99;   //ascii code for 's'
 const int C=67;   //ascii code for 'S'
 const int r=114;  //ascii code for 'r'
@@ -6,6 +12,18 @@ const int R=82;   //ascii code for 'R'
 int bCalibMode;  //boolean, if 1 arduino is place in calibration mode
                 //when put in calibration mode it cannot be used with ros
                 //to exit calibration mode you must restart
+int bStreamMode; //boolean, if 1 arduino sends binary frames as fast as it can
+
+//must match the tactile_baudrate parameter of the sensing node, on a 16 MHz board
+//250000, 500000 and 1000000 are exact, 115200 is 2% off but works with the usual adapters
+const unsigned long BAUD_RATE=9600;
+
+//frame: 0xAA 0x55 | sequence number | 15 ADC values | CRC-16/CCITT of sequence number and values
+//multi byte fields are little endian, see ArduFrameParser in the sensing node
+const byte NUM_CHANNELS=15;
+const byte FRAME_LEN=2+1+2*NUM_CHANNELS+2;
+byte seq;
+
 void setup(){
   
   pinMode(LED_BUILTIN, OUTPUT);
@@ -14,12 +32,12 @@ void setup(){
   digitalWrite(LED_BUILTIN, HIGH);
 
   bCalibMode=0;  //ready for ros
+  bStreamMode=0; //until ros asks for it
+  seq=0;
 
-  //NOTE: the fastest we can go in this system is 38400 bauds, this value
-  //can be given to the function below (and matched in ros) but to calibrate it
-  //you would need to use something like telnet, teraterm or hyperterminal as the
-  //arduino serial monitor struggles to cope with that speed
-  Serial.begin(9600); //initializes the serial port with the pc
+  //NOTE: to calibrate at this speed you would need to use something like telnet,
+  //teraterm or hyperterminal if the arduino serial monitor struggles to cope with it
+  Serial.begin(BAUD_RATE); //initializes the serial port with the pc
   
   while(!Serial);  //get stuck until you are connected to PC
   
@@ -40,9 +58,44 @@ void loop(){
     }
     Serial.println();
   }
+  else if(bStreamMode)
+  {
+    sendFrame();
+  }
 
 }
 
+//CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)
+unsigned int crc16(const byte* data, byte len)
+{
+  unsigned int crc=0xFFFF;
+  for(byte i=0;i<len;i++){
+    crc^=(unsigned int)data[i]<<8;
+    for(byte b=0;b<8;b++){
+      crc=(crc&0x8000) ? (crc<<1)^0x1021 : crc<<1;
+    }
+  }
+  return crc;
+}
+
+//one binary frame with all the channels, the ADC takes about 1.7 msec for them
+void sendFrame()
+{
+  byte frame[FRAME_LEN];
+  frame[0]=0xAA;
+  frame[1]=0x55;
+  frame[2]=seq++;
+  for(byte i=0;i<NUM_CHANNELS;i++){ //reads from pin 0 to pin 14
+    int val=analogRead(i);
+    frame[3+2*i]=lowByte(val);
+    frame[4+2*i]=highByte(val);
+  }
+  unsigned int crc=crc16(frame+2,FRAME_LEN-4);
+  frame[FRAME_LEN-2]=lowByte(crc);
+  frame[FRAME_LEN-1]=highByte(crc);
+  Serial.write(frame,FRAME_LEN); //blocks only while the transmit buffer is full
+}
+
 //surrogate of interrupt
 void serialEvent()
 {
@@ -53,8 +106,17 @@ void serialEvent()
   switch(cmd)
   {
   
+    case s:
+    {
+      if(!bCalibMode)
+      {
+        bStreamMode=1;  //the led stays off, it would slow down the stream
+      }
+      break;
+    }
     case g:
     {
+      bStreamMode=0;  //request/reply from now on
       if(!bCalibMode)
       {
         digitalWrite(LED_BUILTIN, HIGH);
@@ -72,6 +134,7 @@ void serialEvent()
     case 'C':
     {
       bCalibMode=1;
+      bStreamMode=0;
       Serial.println("Switching to calibration mode, enter 'R' to revert to ROS mode, I can't be plugged into ROS");
       delay(1500);
       break;
@@ -8,6 +8,53 @@
 #include "common_defines.h"
 
 
+//one frame streamed by the arduino (see doc/daq_arduino_new/daq_arduino_new.ino), on the wire it is
+//  0xAA 0x55 | sequence number (1 byte) | ADC values (2 bytes each) | CRC-16/CCITT of sequence number and values (2 bytes)
+//multi byte fields are little endian
+struct ArduFrame
+{
+    static const int NUM_ADC=15;
+    unsigned char seq;
+    unsigned short adc[NUM_ADC];
+};
+
+//extracts frames from the byte stream of the arduino, resynchronises on the sync bytes after lost or damaged bytes
+class ArduFrameParser
+{
+public:
+    static const unsigned char SYNC1=0xAA;
+    static const unsigned char SYNC2=0x55;
+    static const int FRAME_LEN=2+1+2*ArduFrame::NUM_ADC+2;
+
+    ArduFrameParser();
+
+    void push(const unsigned char* bytes,int len);  //appends received bytes
+    bool next(ArduFrame& frame);    //returns true and the oldest complete frame with a valid CRC, if there is one
+    void reset();   //drops buffered bytes, e.g. after flushing the port
+
+    static unsigned short crc16(const unsigned char* bytes,int len);
+
+    //statistics since construction
+    unsigned long framesReceived() const {return m_framesReceived;}
+    unsigned long framesLost() const {return m_framesLost;}    //from gaps in the sequence numbers
+    unsigned long crcErrors() const {return m_crcErrors;}
+    unsigned long bytesSkipped() const {return m_bytesSkipped;}    //while searching for the sync bytes
+
+private:
+    static const int BUFF_LEN=1024;
+
+    unsigned char m_buff[BUFF_LEN];
+    int m_len;          //bytes in m_buff
+    int m_lastSeq;      //-1 if no frame was received since the last reset
+
+    unsigned long m_framesReceived;
+    unsigned long m_framesLost;
+    unsigned long m_crcErrors;
+    unsigned long m_bytesSkipped;
+
+    void drop(int len);     //removes len bytes from the front of m_buff
+};
+
 
 class Driver{   //abstract class: everything in common across sensors is here
 //nothing here (no private data)
@@ -15,6 +62,9 @@ protected:
     std::string m_portname; //name of the arduino port
     int m_fileDesc;         //file descriptor for termios
     std::vector<double> m_sensor_values;
+    int m_baudrate;         //of the arduino port
+    bool m_streaming;       //arduino streams binary frames, otherwise data is requested with CMD_GETDATA
+    ArduFrameParser m_parser;
 
     static const int NUM_TACT; //num of tactile sensors
     static const int NUM_PROX; //num of proximity sensors
@@ -25,7 +75,9 @@ protected:
     //config matrix (filename?)
 
     virtual bool setup();   //assuming setup is equal for 2 sensors on 3
+    RES_COMMS streamRead(std::vector<double>& data);    //latest streamed frame, called by arduRead in streaming mode
 
+    Driver();
 
 public:
     virtual bool readData(std::vector<double>&)=0;  //this function reads the data from the sensors and returns a vector (double[][])
@@ -34,6 +86,8 @@ public:
 
 private:
     static const char CMD_GETDATA[5];  //command to fetch data from arduino
+    static const char CMD_STREAM[2];   //command to make arduino stream frames
+    static const int STREAM_TIMEOUT;   //msec without any frame before the stream is considered broken
 
 
 };
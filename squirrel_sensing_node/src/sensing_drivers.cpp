@@ -10,6 +10,7 @@
 #include <sstream>
 #include <cmath>
 #include <assert.h>
+#include <string.h>
 #include <ros/package.h>
 #include <ros/ros.h>
 
@@ -21,30 +22,194 @@
 using namespace std;
 
 const char Driver::CMD_GETDATA[]="g"; //arduino command to get data
+const char Driver::CMD_STREAM[]="s";  //arduino command to stream data
 const int INVALID_DATA=-100;
 const int Driver::MAX_RETRIES=5;   //we try 5 times to read
+const int Driver::STREAM_TIMEOUT=100;  //the arduino sends hundreds of frames per second
 const double Driver::MAX_VOLTS=5.0;
 
+//------------------------------FRAME PARSER
+
+const int ArduFrame::NUM_ADC;
+const unsigned char ArduFrameParser::SYNC1;
+const unsigned char ArduFrameParser::SYNC2;
+const int ArduFrameParser::FRAME_LEN;
+const int ArduFrameParser::BUFF_LEN;
+
+ArduFrameParser::ArduFrameParser()
+{
+    m_framesReceived=0;
+    m_framesLost=0;
+    m_crcErrors=0;
+    m_bytesSkipped=0;
+    reset();
+}
+
+void ArduFrameParser::reset()
+{
+    m_len=0;
+    m_lastSeq=-1;   //the first frame after a reset is never counted as a gap
+}
+
+void ArduFrameParser::drop(int len)
+{
+    m_len-=len;
+    memmove(m_buff,m_buff+len,m_len);
+}
+
+void ArduFrameParser::push(const unsigned char* bytes,int len)
+{
+    if(len>BUFF_LEN)    //only the newest bytes can still hold a frame worth reading
+    {
+        m_bytesSkipped+=len-BUFF_LEN;
+        bytes+=len-BUFF_LEN;
+        len=BUFF_LEN;
+    }
+    if(m_len+len>BUFF_LEN)  //the oldest bytes have to give way
+    {
+        m_bytesSkipped+=m_len+len-BUFF_LEN;
+        drop(m_len+len-BUFF_LEN);
+    }
+    memcpy(m_buff+m_len,bytes,len);
+    m_len+=len;
+}
+
+bool ArduFrameParser::next(ArduFrame& frame)
+{
+    while(true)
+    {
+        //look for the sync bytes, everything in front of them is garbage
+        int start=0;
+        while(start<m_len && !(m_buff[start]==SYNC1 && (start+1==m_len || m_buff[start+1]==SYNC2)))
+        {
+            ++start;
+        }
+        if(start>0)
+        {
+            m_bytesSkipped+=start;
+            drop(start);
+        }
+
+        if(m_len<FRAME_LEN)    //wait for the rest of the frame
+        {
+            return false;
+        }
+
+        unsigned short crc=m_buff[FRAME_LEN-2] | (m_buff[FRAME_LEN-1]<<8);
+        if(crc!=crc16(m_buff+2,FRAME_LEN-4))
+        {
+            //either a damaged frame or the sync bytes were part of the data, resynchronise after them
+            ++m_crcErrors;
+            ++m_bytesSkipped;
+            drop(1);
+            continue;
+        }
+
+        frame.seq=m_buff[2];
+        for(int i=0;i<ArduFrame::NUM_ADC;++i)
+        {
+            frame.adc[i]=m_buff[3+2*i] | (m_buff[4+2*i]<<8);
+        }
+        drop(FRAME_LEN);
+
+        if(m_lastSeq>=0)
+        {
+            m_framesLost+=(unsigned char)(frame.seq-m_lastSeq-1);  //sequence numbers wrap at 256
+        }
+        m_lastSeq=frame.seq;
+        ++m_framesReceived;
+        return true;
+    }
+}
+
+//CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF), the arduino computes the same
+unsigned short ArduFrameParser::crc16(const unsigned char* bytes,int len)
+{
+    unsigned short crc=0xFFFF;
+    for(int i=0;i<len;++i)
+    {
+        crc^=bytes[i]<<8;
+        for(int b=0;b<8;++b)
+        {
+            crc=(crc&0x8000) ? (crc<<1)^0x1021 : crc<<1;
+        }
+    }
+    return crc;
+}
+
+//------------------------------DRIVER
+
+//termios speed for a baud rate, false if the rate is not supported
+static bool baudToSpeed(int baudrate,speed_t& speed)
+{
+    switch(baudrate)
+    {
+    case 9600: speed=B9600; return true;
+    case 19200: speed=B19200; return true;
+    case 38400: speed=B38400; return true;
+    case 57600: speed=B57600; return true;
+    case 115200: speed=B115200; return true;
+    case 230400: speed=B230400; return true;
+#ifdef B500000
+    case 500000: speed=B500000; return true;
+#endif
+#ifdef B1000000
+    case 1000000: speed=B1000000; return true;
+#endif
+    default: return false;
+    }
+}
+
+Driver::Driver()
+{
+    m_fileDesc=-1;
+    m_baudrate=9600;
+    m_streaming=false;
+}
+
 //makes the connection with m_portname
 bool Driver::setup(){    //assuming setup is equal for 2 sensros on 3
 
+    speed_t speed;
+    if(!baudToSpeed(m_baudrate,speed))
+    {
+        cout << "Driver::setup> ERROR! Unsupported baud rate " << m_baudrate << endl;
+        return false;
+    }
+
     m_fileDesc=open(m_portname.c_str(), O_RDWR | O_NOCTTY | O_NDELAY);
+    if(m_fileDesc<0)
+    {
+        cout << "Driver::setup> ERROR! Couldn't open " << m_portname << endl;
+        return false;
+    }
     fcntl(m_fileDesc, F_SETFL,0);//reset file status flags
 
     /* Set up the control structure */
      struct termios toptions;
      /* Get currently set options for the tty */
      tcgetattr(m_fileDesc, &toptions);
-     /* 9600 baud */
-      cfsetispeed(&toptions, B9600);   //enter here B38400 for max baudrate for this system, arduino must match this speed, B9600 was the previous, slowest, value which was proven to work in the larger system
-      cfsetospeed(&toptions, B9600);   //enter here B38400 for max baudrate for this system, arduino must match this speed (both lines must have the same speed set here)
+     /* baud rate, arduino must match this speed (both lines must have the same speed set here) */
+      cfsetispeed(&toptions, speed);   //9600 is the slowest value which was proven to work in the larger system with request/reply
+      cfsetospeed(&toptions, speed);
       /* 8 bits, no parity, no stop bits */
        toptions.c_cflag &= ~PARENB;
        toptions.c_cflag &= ~CSTOPB;
        toptions.c_cflag &= ~CSIZE;
        toptions.c_cflag |= CS8; //should be one stop bit
+       if(m_streaming)
+       {
+           /* raw mode for the binary frames, reads return whatever is available without waiting */
+           cfmakeraw(&toptions);
+           toptions.c_cflag |= CREAD | CLOCAL;
+           toptions.c_cc[VMIN]=0;
+           toptions.c_cc[VTIME]=0;
+       }
+       else
+       {
        /* Canonical mode */
         toptions.c_lflag |= ICANON;
+       }
 
         //---------------------------------------------------------------
         /*non canonical mode */
@@ -67,17 +232,110 @@ bool Driver::setup(){    //assuming setup is equal for 2 sensros on 3
      /* Flush anything already in the serial buffer */
      tcflush(m_fileDesc, TCIFLUSH);
 
+     if(m_streaming)    //if the arduino is still resetting after the port was opened, streamRead asks again
+     {
+         ssize_t wrbytes=write(m_fileDesc,CMD_STREAM,1);
+         (void)wrbytes;
+     }
+
      return true;
 }
 
 void Driver::flush(){
     /* Flush anything already in the serial buffer */
     tcflush(m_fileDesc, TCIFLUSH);
+    m_parser.reset();   //a partial frame can't be completed anymore
+}
+
+
+RES_COMMS Driver::streamRead(vector<double>& data)
+{
+    unsigned char rd_buff[256];
+    ArduFrame frame;
+    bool hasFrame=false;
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = STREAM_TIMEOUT*1000;
+
+    //everything that arrived since the last call is parsed, only the latest frame is returned to keep the latency low
+    while(true)
+    {
+        ssize_t rdbytes=read(m_fileDesc,rd_buff,sizeof(rd_buff));  //does not block in raw mode
+        if(rdbytes<0)
+        {
+            cout << "Driver::streamRead> ERROR! Read error: " << strerror(errno) << endl;
+            break;
+        }
+        if(rdbytes>0)
+        {
+            m_parser.push(rd_buff,rdbytes);
+            while(m_parser.next(frame))
+            {
+                hasFrame=true;
+            }
+            if(rdbytes==(ssize_t)sizeof(rd_buff))    //there might be more
+            {
+                continue;
+            }
+        }
+        if(hasFrame)
+        {
+            break;
+        }
+
+        //nothing new yet, wait for the next frame
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        FD_SET(m_fileDesc, &read_fds);
+        if(select(m_fileDesc + 1, &read_fds, NULL, NULL, &timeout) <= 0)
+        {
+            break;
+        }
+    }
+
+    if(m_parser.crcErrors()>0 || m_parser.framesLost()>0)
+    {
+        ROS_WARN_THROTTLE(10.0,"Driver::streamRead> %lu frames received, %lu lost, %lu CRC errors, %lu bytes skipped",
+                          m_parser.framesReceived(),m_parser.framesLost(),m_parser.crcErrors(),m_parser.bytesSkipped());
+    }
+
+    if(!hasFrame)
+    {
+        cout << "Driver::streamRead> ERROR! No frame received from arduino for " << STREAM_TIMEOUT << " msec"
+             << " (does the sketch stream at tactile_baudrate? set tactile_streaming to false for request/reply sketches)" << endl;
+        //the arduino might have been reset, ask it to stream again
+        ssize_t wrbytes=write(m_fileDesc,CMD_STREAM,1);
+        for(uint i=0;i<NUM_VALS;++i)
+        {
+            data.push_back(INVALID_DATA);
+        }
+        return (wrbytes==1 ? RES_CANNOT_READ : RES_CANNOT_WRITE);
+    }
+
+    //same conversion and checks as for the values sent as text
+    RES_COMMS result=RES_SUCCESS;
+    for(int i=0;i<NUM_VALS && i<ArduFrame::NUM_ADC;++i)
+    {
+        double val=frame.adc[i]*(5.0 / 1023.0);
+        if(val>MAX_VOLTS || val <=0)
+        {
+            val=INVALID_DATA;
+            result=RES_INVALID_DATA;
+        }
+        data.push_back(val);
+    }
+
+    return result;
 }
 
 
 RES_COMMS Driver::arduRead(vector<double>& data)
 {
+    if(m_streaming)
+    {
+        return streamRead(data);
+    }
+
     const int CMD_BUF_LEN=3;
     char rpy_buff[255];
 
@@ -265,6 +523,11 @@ std::vector<double> Tactile::m_maximumForce;
 Tactile::Tactile(const std::string& portname){
 
     m_portname=portname;
+
+    //the arduino firmware has to match, the defaults fit doc/daq_arduino_new as shipped and the older 9600 baud sketches
+    ros::NodeHandle private_nh("~");
+    private_nh.param("tactile_baudrate",m_baudrate,9600);
+    private_nh.param("tactile_streaming",m_streaming,false);
     m_divider=0;	//we shall never divide by 0
     for(int i=0;i<(3*2);++i)
     {